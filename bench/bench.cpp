@@ -0,0 +1,256 @@
+/* Copyright (c) 2021
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public
+* License as published by the Free Software Foundation; either
+* version 2 of the License, or (at your option) any later version.
+#
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* General Public License for more details.
+#
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the
+* Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+* Boston, MA 02110-1301 USA
+#
+* Microbenchmarks for the gptokeyb hot paths, run with `make bench`.
+* Emitted events are captured in memory, so neither a gamepad nor /dev/uinput is needed.
+*/
+
+#define GPTOKEYB_NO_MAIN
+#include "../gptokeyb.cpp"
+
+#include <new>
+
+#ifndef BENCH_CONFIG_DIR
+#define BENCH_CONFIG_DIR "configs" // set by make bench, so the binary runs from any directory
+#endif
+
+static std::atomic<unsigned long> allocations{0};
+
+void* operator new(size_t size)
+{
+  allocations++;
+  if (void* ptr = malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+  free(ptr);
+}
+
+static std::vector<struct input_event> emitted;
+
+template <typename Body>
+void bench(const char* name, long iterations, Body body)
+{
+  body(); // warm up caches and let vectors reach their working size
+  emitted.clear();
+
+  unsigned long allocations_before = allocations;
+  Uint64 start = monotonicNanos();
+  for (long ii = 0; ii < iterations; ii++) {
+    body();
+    emitted.clear();
+  }
+  Uint64 elapsed = monotonicNanos() - start;
+
+  printf(
+    "%-36s %12.1f ns/op %8.2f allocs/op\n",
+    name,
+    (double)elapsed / iterations,
+    (double)(allocations - allocations_before) / iterations);
+}
+
+// send everything queued for the key sequencer, without waiting for its pauses
+void drainKeySequence()
+{
+  while (key_sequence.due_ns != 0) {
+    runKeySequence(key_sequence.due_ns);
+  }
+  flushEmitBatch();
+}
+
+SDL_Event buttonEvent(int button, bool is_pressed)
+{
+  SDL_Event event;
+  memset(&event, 0, sizeof(event));
+  event.type = is_pressed ? SDL_CONTROLLERBUTTONDOWN : SDL_CONTROLLERBUTTONUP;
+  event.cbutton.button = button;
+  event.cbutton.state = is_pressed ? SDL_PRESSED : SDL_RELEASED;
+  return event;
+}
+
+SDL_Event axisEvent(int axis, int value)
+{
+  SDL_Event event;
+  memset(&event, 0, sizeof(event));
+  event.type = SDL_CONTROLLERAXISMOTION;
+  event.caxis.axis = axis;
+  event.caxis.value = value;
+  return event;
+}
+
+// every option once, every cycling button with a full set of keys, and a lot of comments
+std::string writeLargeConfig()
+{
+  char path[] = "/tmp/gptokeyb-bench-XXXXXX";
+  int fd = mkstemp(path);
+  FILE* fp = fdopen(fd, "w");
+  const char* cycling[] = {"a", "a_hk", "b", "b_hk", "x", "x_hk", "y", "y_hk", "l1", "l1_hk", "r1", "r1_hk"};
+  const char* keys[] = {"f1", "f2", "f3", "f4", "f5", "f6", "f7", "f8", "f9", "f10", "f11", "f12"};
+  for (const char* button : cycling) {
+    fprintf(fp, "# keys for %s\n", button);
+    for (const char* key : keys) {
+      fprintf(fp, "%s = %s\n", button, key);
+    }
+    fprintf(fp, "%s = add_ctrl\n", button);
+  }
+  const char* single[] = {"back", "start", "guide", "l2", "l2_hk", "l3", "r2", "r2_hk", "r3", "up", "down", "left", "right",
+    "left_analog_up", "left_analog_down", "left_analog_left", "left_analog_right",
+    "right_analog_up", "right_analog_down", "right_analog_left", "right_analog_right"};
+  for (const char* button : single) {
+    fprintf(fp, "%s = pagedown\n%s = add_alt\n", button, button);
+    if (strstr(button, "_hk") == NULL) { // hotkey combinations don't repeat
+      fprintf(fp, "%s = repeat\n", button);
+    }
+  }
+  fprintf(fp, "deadzone_y = 2100\ndeadzone_x = 1900\ndeadzone_triggers = 3000\nmouse_scale = 512\nmouse_delay = 16\n");
+  for (int ii = 0; ii < 1000; ii++) {
+    fprintf(fp, "# padding comment line %d to make the file larger\n", ii);
+  }
+  fclose(fp);
+  return path;
+}
+
+int main()
+{
+  emitted.reserve(4096);
+  emit_capture = &emitted;
+  skip_emit_pauses = true;
+  textinputinteractive_mode = true;
+  textinputinteractive_extrasymbols = true;
+  selectTextLayout("us");
+  initialiseCharacterSet();
+
+  const long iterations = 200000;
+  const config_settings default_config = config;
+
+  printf("%-36s %15s %18s\n", "benchmark", "time", "allocations");
+
+  bench("handleEvent button A press+release", iterations, [] {
+    handleEvent(buttonEvent(SDL_CONTROLLER_BUTTON_A, true));
+    flushEmitBatch();
+    handleEvent(buttonEvent(SDL_CONTROLLER_BUTTON_A, false));
+    flushEmitBatch();
+  });
+
+  bench("handleEvent dpad up press+release", iterations, [] {
+    handleEvent(buttonEvent(SDL_CONTROLLER_BUTTON_DPAD_UP, true));
+    flushEmitBatch();
+    handleEvent(buttonEvent(SDL_CONTROLLER_BUTTON_DPAD_UP, false));
+    flushEmitBatch();
+  });
+
+  bench("handleEvent left stick to key", iterations, [] {
+    handleEvent(axisEvent(SDL_CONTROLLER_AXIS_LEFTX, -30000));
+    flushEmitBatch();
+    handleEvent(axisEvent(SDL_CONTROLLER_AXIS_LEFTX, 0));
+    flushEmitBatch();
+  });
+
+  bench("handleEvent stick inside deadzone", iterations, [] {
+    handleEvent(axisEvent(SDL_CONTROLLER_AXIS_LEFTY, 1000));
+    flushEmitBatch();
+  });
+
+  bench("handleEvent L2 trigger", iterations, [] {
+    handleEvent(axisEvent(SDL_CONTROLLER_AXIS_TRIGGERLEFT, 32767));
+    flushEmitBatch();
+    handleEvent(axisEvent(SDL_CONTROLLER_AXIS_TRIGGERLEFT, 0));
+    flushEmitBatch();
+  });
+
+  const char* realistic_config = BENCH_CONFIG_DIR "/default.gptk";
+  std::string large_config = writeLargeConfig();
+
+  bench("parseConfigFile realistic", 20000, [&] {
+    parseConfigFile(realistic_config);
+  });
+
+  bench("parseConfigFile large", 2000, [&] {
+    parseConfigFile(large_config.c_str());
+  });
+
+  bench("readConfigFile realistic", 20000, [&] {
+    config = default_config;
+    readConfigFile(realistic_config);
+  });
+
+  bench("readConfigFile large", 2000, [&] {
+    config = default_config;
+    readConfigFile(large_config.c_str());
+  });
+
+  char cache_dir[] = "/tmp/gptokeyb-bench-cache-XXXXXX";
+  setenv("GPTOKEYB_CACHE_DIR", mkdtemp(cache_dir), 1);
+  bench("loadConfig large cached", 2000, [&] {
+    config = default_config;
+    loadConfig(large_config.c_str());
+  });
+  unlink(configCachePath(large_config.c_str()).c_str());
+  rmdir(cache_dir);
+  config = default_config;
+  unlink(large_config.c_str());
+
+  config.fake_mouse_curve = MOUSE_CURVE_EXPONENTIAL;
+  buildMouseCurve();
+  state.mouseX = 21000;
+  state.mouseY = -17000;
+  bench("mouse tick exponential curve", iterations * 10, [] {
+    mouseTick(monotonicNanos());
+    flushEmitBatch();
+  });
+  state.mouseX = 0;
+  state.mouseY = 0;
+  config = default_config;
+
+  const char* names[] = {"up", "esc", "enter", "a", "m", "z", "5", "f1", "f12", "@", ">", "menu"};
+  size_t name = 0;
+  bench("char_to_keycode", iterations * 10, [&] {
+    volatile short keycode = char_to_keycode(names[name]);
+    (void)keycode;
+    name = (name + 1) % (sizeof(names) / sizeof(names[0]));
+  });
+
+  char preset[] = "Hello World 123";
+  text_input_preset = preset;
+  bench("processKeys \"Hello World 123\"", iterations / 10, [] {
+    processKeys();
+    drainKeySequence();
+  });
+
+  bench("emitTextInputKey uppercase", iterations, [] {
+    emitTextInputKey(KEY_A, true);
+    drainKeySequence();
+  });
+
+  bench("text input next+previous character", iterations, [] {
+    nextTextInputKey(true);
+    prevTextInputKey(true);
+    drainKeySequence();
+  });
+
+  printEmitStats();
+  return 0;
+}
@@ -36,6 +36,10 @@
 * Spaghetti code incoming, beware :)
 */
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <dirent.h>
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -47,14 +51,44 @@
 #include <libevdev-1.0/libevdev/libevdev.h>
 
 #include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
 #include <sstream>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <vector>
 
 #include <SDL.h>
 
+#include "keycodes.h"
+
+#ifndef SYS_pidfd_open // older kernel headers, both numbers are shared by arm, arm64 and x86
+#define SYS_pidfd_open 434
+#endif
+#ifndef SYS_pidfd_send_signal
+#define SYS_pidfd_send_signal 424
+#endif
+
 #define CONFIG_ARG_MAX_BYTES 128
+#define MOUSE_CURVE_MAX_POINTS 16
+#define SCROLL_UNITS_PER_NOTCH 120 // high-resolution wheel units in one wheel click
+
+#ifndef REL_WHEEL_HI_RES // kernel headers older than 5.0
+#define REL_WHEEL_HI_RES 0x0b
+#define REL_HWHEEL_HI_RES 0x0c
+#endif
 #define SDL_DEFAULT_REPEAT_DELAY 500
 #define SDL_DEFAULT_REPEAT_INTERVAL 30
 
@@ -70,7 +104,7 @@ std::vector<config_option> parseConfigFile(const char* path)
 
   FILE* fp;
 
-  if ((fp = fopen(path, "r+")) == NULL) {
+  if ((fp = fopen(path, "r")) == NULL) {
     perror("fopen()");
     return result;
   }
@@ -98,19 +132,143 @@ std::vector<config_option> parseConfigFile(const char* path)
     }
   }
 
+  fclose(fp);
   return result;
 }
 
 static int uinp_fd = -1;
-struct uinput_user_dev uidev;
+int emit_fd = -1; // uinput device reports are written to, in xbox360 mode the fake pad of the last input
+struct libevdev_uinput* uinput_device = NULL;
+struct libevdev* uinput_description = NULL; // what the fake device declared, codes a reloaded config adds need a restart
+
+// input-to-uinput latency, one histogram per kind of input; updated with relaxed atomics only
+// so that the hot path never locks or allocates, and SIGUSR1 can dump it from the signal handler
+enum latency_class
+{
+  LATENCY_BUTTON,
+  LATENCY_AXIS, // analog stick or trigger assigned to keys
+  LATENCY_MOUSE, // fake mouse movement tick
+  LATENCY_REPEAT, // key repeat tick
+  LATENCY_TURBO, // turbo toggle, timed from when it was due so this is the cadence jitter
+  LATENCY_TEXT, // text input preset and interactive text input
+  LATENCY_CLASSES
+};
+const char* latency_class_names[LATENCY_CLASSES] = {"buttons", "axis", "mouse", "repeat", "turbo", "text"};
+
+// log-linear buckets in microseconds: 8 sub-buckets for each power of two, so about 12% resolution
+#define LATENCY_SUB_BUCKETS 8
+#define LATENCY_BUCKETS (32 * LATENCY_SUB_BUCKETS)
+
+struct latency_histogram
+{
+  std::atomic<Uint32> buckets[LATENCY_BUCKETS];
+  std::atomic<Uint32> samples;
+  std::atomic<Uint32> max_us;
+};
+latency_histogram latency_histograms[LATENCY_CLASSES];
+Uint64 sdl_ticks_origin_ns = 0; // monotonic time at which SDL_GetTicks() was 0
+Uint64 evdev_input_time_ns = 0; // kernel timestamp of the evdev event being handled
+const char* latency_dump_file = NULL; // SIGUSR1 writes to stderr unless GPTOKEYB_LATENCY_FILE is set
+
+// input events emitted while handling one input frame are batched and written to uinput together
+#define EMIT_BATCH_MAX_EVENTS 64
+
+struct emit_batch_buffer
+{
+  struct input_event events[EMIT_BATCH_MAX_EVENTS];
+  int axis_before[EMIT_BATCH_MAX_EVENTS]; // of an EV_ABS event, the value the device holds until it is written
+  int count;
+  int syncs_requested; // SYN_REPORTs asked for since last flush, only one is written
+  bool latency_pending; // an input is waiting for its first report to be written
+  latency_class latency_input_class;
+  Uint64 latency_start_ns;
+};
+// only the event loop thread emits and writes to uinput; the SDL event thread, mouse ticks and key
+// repeats all hand their work to it, so events of different inputs never interleave within a report
+static emit_batch_buffer emit_batch;
+
+// what a fake device has asserted, one bit per key, so that everything held can be released in one
+// report when the mapping changes, a controller goes away, text input takes over or gptokeyb exits
+#define KEY_LEDGER_WORDS ((KEY_CNT + 63) / 64)
+struct key_ledger
+{
+  Uint64 keys[KEY_LEDGER_WORDS]; // EV_KEY codes pressed
+  int axes[ABS_CNT]; // last EV_ABS value of each code, unchanged values are not sent again
+};
+key_ledger device_ledger; // the fake device created at startup
+key_ledger* held = &device_ledger; // of the device emit() writes to
+
+bool keyHeld(int code)
+{
+  return (held->keys[code / 64] >> (code % 64)) & 1;
+}
+
+struct
+{
+  std::atomic<unsigned long> events{0}; // EV_KEY/EV_REL/EV_ABS events written
+  std::atomic<unsigned long> writes{0}; // write() syscalls issued
+  std::atomic<unsigned long> legacy_writes{0}; // write() syscalls needed when writing one event at a time
+  std::atomic<unsigned long> max_depth{0}; // most events written in one report
+  std::atomic<unsigned long> overflows{0}; // frames split into two reports because the batch was full
+  std::atomic<unsigned long> dropped{0}; // events uinput did not take, the rest of their report was dropped too
+  std::atomic<unsigned long> coalesced{0}; // axis updates merged into the pending report, or not sent because the value was unchanged
+} emit_stats;
+
+// event loop wakeups, to check that an idle process really sleeps; dumped with SIGUSR1
+struct
+{
+  std::atomic<unsigned long> wakeups{0};
+  std::atomic<unsigned long> timer_wakeups{0}; // mouse ticks and key repeats
+  Uint64 start_ns = 0;
+  unsigned long last_dump_wakeups = 0; // only touched by the SIGUSR1 handler
+  Uint64 last_dump_ns = 0;
+} loop_stats;
+
+// config hot reloads, dumped with SIGUSR1
+struct
+{
+  std::atomic<unsigned long> reloads{0};
+  std::atomic<unsigned long> failures{0}; // unreadable file or config errors, the previous mapping was kept
+  std::atomic<unsigned long> last_us{0}; // time the last successful reload took
+} reload_stats;
+
+// interactive text input scrolling, dumped with SIGUSR1
+struct
+{
+  std::atomic<unsigned long> steps{0}; // selection changes
+  std::atomic<unsigned long> shown{0}; // characters sent to the game for them
+  std::atomic<unsigned long> events_saved{0}; // key events the skipped characters would have sent
+} text_input_stats;
+
+// when set, flushed reports are appended here instead of being written to /dev/uinput (trace replay, benchmarks)
+std::vector<struct input_event>* emit_capture = NULL;
+bool skip_emit_pauses = false; // replaying a trace as fast as possible or benchmarking, pauses between key presses are skipped
+FILE* trace_record_file = NULL; // -record
+const char* trace_replay_file = NULL; // -replay
+const char* trace_dump_file = NULL; // -replay-dump
 
 bool kill_mode = false;
 bool sudo_kill = false; //allow sudo kill instead of killall for non-emuelec systems
 bool pckill_mode = false; //emit alt+f4 to close apps on pc during kill mode, if env variable is set
+int kill_grace_ms = 3000; // KILLGRACE, how long kill mode waits for the app to exit before SIGKILL
+
+// gptokeyb -- <command>: the app is started as our child in a cgroup of its own, so it is known by
+// its pid instead of its name, and kill mode takes down everything it started
+struct launched_app
+{
+  char** argv = NULL;
+  pid_t pid = -1;
+  int pidfd = -1; // readable once the app has exited
+  int sigchld_fd = -1; // signalfd, for kernels without pidfd_open (before 5.3)
+  std::string cgroup; // empty when no cgroup could be created, its process group is used instead
+  bool exited = false;
+  int exit_status = 0; // gptokeyb exits with it
+} launched;
 bool openbor_mode = false;
 bool xbox360_mode = false;
 bool textinputpreset_mode = false; 
 bool textinputinteractive_mode = false;
+char* text_input_preset = NULL; // TEXTINPUTPRESET, kept out of config so that config stays a flat image
 bool textinputinteractive_noautocapitals = false;
 bool textinputinteractive_extrasymbols = false;
 bool app_exult_adjust = false;
@@ -119,8 +277,9 @@ const int maxKeysNoExtendedSymbols = 69; //number of keys available for interact
 const int maxKeysWithSymbols = 96; //number of keys available for interactive text input with extra symbols
 int maxKeys = maxKeysNoExtendedSymbols;
 const int maxChars = 20; // length of text in characters that can be entered
-int character_set[maxKeysWithSymbols]; // keys that can be selected in text input interactive mode
-bool character_set_shift[maxKeysWithSymbols]; // indicate which keys require shift
+// characters that can be selected in text input interactive mode, the extra symbols start at maxKeysNoExtendedSymbols
+const char text_input_characters[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789 .,-_()@#%&*-+!\"':;/?~`|{}$^=[]\\<>";
+static_assert(sizeof(text_input_characters) == maxKeysWithSymbols + 1, "text_input_characters must list maxKeysWithSymbols characters");
 int current_character = 0; 
 int current_key[maxChars]; // current key selected for each key
 char* AppToKill;
@@ -128,2399 +287,4243 @@ bool config_mode = false;
 bool hotkey_override = false;
 bool emuelec_override = false;
 char* hotkey_code;
+int hotkey_button = -1; // button named by hotkey_code
+
+// inputs that can be bound to keys: the SDL game controller buttons, then stick directions and analog triggers
+enum binding_input
+{
+  INPUT_LEFT_ANALOG_UP = SDL_CONTROLLER_BUTTON_DPAD_RIGHT + 1,
+  INPUT_LEFT_ANALOG_DOWN,
+  INPUT_LEFT_ANALOG_LEFT,
+  INPUT_LEFT_ANALOG_RIGHT,
+  INPUT_RIGHT_ANALOG_UP,
+  INPUT_RIGHT_ANALOG_DOWN,
+  INPUT_RIGHT_ANALOG_LEFT,
+  INPUT_RIGHT_ANALOG_RIGHT,
+  INPUT_L2,
+  INPUT_R2,
+  BINDING_INPUTS
+};
+
+// config file names of the inputs, the hotkey layer adds "_hk"
+const char* const binding_input_names[BINDING_INPUTS] = {
+  "a", "b", "x", "y", "back", "guide", "start", "l3", "r3", "l1", "r1", "up", "down", "left", "right",
+  "left_analog_up", "left_analog_down", "left_analog_left", "left_analog_right",
+  "right_analog_up", "right_analog_down", "right_analog_left", "right_analog_right",
+  "l2", "r2"};
+
+enum binding_layer
+{
+  LAYER_BASE,
+  LAYER_HOTKEY, // input pressed while the hotkey is held
+  BINDING_LAYERS
+};
+
+#define BINDING_MAX_KEYS 12
+#define TURBO_DEFAULT_HZ 10
+#define TURBO_MAX_HZ 100 // a press and a release per period, faster than most games read input
+
+struct binding
+{
+  short keys[BINDING_MAX_KEYS]; // sent in turn on each press when more than one is assigned
+  short modifiers[BINDING_MAX_KEYS];
+  int total_keys; // assigned by the config file, keys[0] is the default while none are
+  bool repeat;
+  Uint32 repeat_delay; // 0 uses repeat_delay/repeat_interval
+  Uint32 repeat_interval;
+  Uint32 turbo_hz; // presses and releases the key this many times a second while held, 0 for none
+};
+
+constexpr binding defaultBinding(short key)
+{
+  return {{key}, {0}, 0, false, 0, 0, 0};
+}
+
+// what an input sent when it was pressed, so its release matches even if the hotkey or config changed meanwhile
+struct binding_state
+{
+  int cycle[BINDING_LAYERS]; // next key of each layer's set
+  bool pressed;
+  int layer;
+  short key;
+  short modifier;
+};
+
+#define REPEAT_TEXT_INPUT BINDING_INPUTS // up/down of interactive text input, which repeat by changing the character
+#define REPEAT_SLOTS (BINDING_INPUTS + 1)
+
+// a held key that repeats, every input has its own schedule
+struct key_repeat
+{
+  Uint64 due_ns;
+  int slot; // input it belongs to, or REPEAT_TEXT_INPUT
+  short key;
+  short modifier;
+  Uint64 interval_ns;
+  bool turbo; // toggles the key each interval instead of pressing it again
+};
 
 struct
 {
-  int hotkey_jsdevice;
-  int start_jsdevice;
-  int textinputinteractivetrigger_jsdevice; // to trigger text input interactive
-  int textinputpresettrigger_jsdevice; // to trigger text input preset
-  int textinputconfirmtrigger_jsdevice; // to trigger text input confirm via Enter key
-  int mouseX = 0;
+  int mouseX = 0; // deflection of the stick used as mouse, after the deadzone
   int mouseY = 0;
+  Sint64 mouse_remainder_x = 0; // sub-pixel movement carried to the next tick, 32.32 fixed point
+  Sint64 mouse_remainder_y = 0;
+  int scrollX = 0; // deflection of the stick used as scroll wheel, after the deadzone
+  int scrollY = 0;
+  Sint64 scroll_remainder_x = 0; // fraction of a high-resolution wheel unit, 32.32 fixed point
+  Sint64 scroll_remainder_y = 0;
+  int scroll_notch_x = 0; // high-resolution units not yet sent as a whole REL_HWHEEL/REL_WHEEL click
+  int scroll_notch_y = 0;
+  bool hotkey_pressed = false; // hotkey held on any pad, selects the hotkey layer
+  bool hotkey_was_pressed = false; // indicates hotkey button has been pressed, and key may need to be processed on button's release, if hotkey combo isn't triggered
+  bool start_was_pressed = false; // indicates start button has been pressed, and key may need to be processed on button's release, if start combo isn't triggered
+  bool textinputinteractive_mode_active = false;
+  bool hotkey_combo_triggered = false; //keep track of whether a hotkey combo was pressed; if so, don't send hotkey key when hotkey is released
+  bool start_combo_triggered = false; //keep track of whether a start combo was pressed; if so, don't send start key when start is released
+  binding_state bindings[BINDING_INPUTS] = {};
+  int input_holders[BINDING_INPUTS] = {}; // pads holding each input, its key is released when the last one lets go
+  key_repeat repeats[REPEAT_SLOTS]; // min-heap on the due time, repeats[0] is the next key repeat
+  int total_repeats = 0;
+  int repeat_position[REPEAT_SLOTS] = {}; // index + 1 of each slot's entry in repeats, 0 when it isn't repeating
+  Uint64 mouse_tick_ns = 0; // next fake mouse movement, 0 while the sticks are centred
+  bool text_input_pending = false; // interactive text input selection not sent to the game yet
+  Uint64 text_input_refresh_ns = 0; // when the next selection may be sent
+} state;
+
+// one slot per controller, so two players never share stick or combo state; in xbox360 mode every
+// slot has a fake pad of its own, otherwise all of them type on the one fake keyboard
+#define PAD_SLOTS 8 // more controllers are ignored
+#define PAD_SLOT_MAP 32 // power of two, SDL instance ids are looked up here with linear probing
+
+struct pad_slot
+{
+  bool in_use = false;
+  SDL_JoystickID instance_id = -1;
+  SDL_GameController* controller = NULL; // NULL for -evdev pads and replayed traces
+  struct libevdev_uinput* uinput = NULL; // its fake Xbox 360 pad
+  int uinput_fd = -1;
+  key_ledger ledger = {}; // unless the pad is the device created at startup, which has device_ledger
   int current_left_analog_x = 0;
   int current_left_analog_y = 0;
   int current_right_analog_x = 0;
   int current_right_analog_y = 0;
   int current_l2 = 0;
   int current_r2 = 0;
-  bool hotkey_pressed = false; // current state of hotkey
-  bool hotkey_was_pressed = false; // indicates hotkey button has been pressed, and key may need to be processed on button's release, if hotkey combo isn't triggered
+  bool inputs_held[BINDING_INPUTS] = {}; // this pad's share of state.input_holders
+  bool hotkey_pressed = false; // combos only count when hotkey, start and trigger are held on the same pad
   bool start_pressed = false;
-  bool start_was_pressed = false; // indicates start button has been pressed, and key may need to be processed on button's release, if start combo isn't triggered
-  bool textinputinteractive_mode_active = false;
-  bool textinputinteractivetrigger_pressed = false;
-  bool textinputpresettrigger_pressed = false;
-  bool textinputconfirmtrigger_pressed = false;
-  bool left_analog_was_up = false;
-  bool left_analog_was_down = false;
-  bool left_analog_was_left = false;
-  bool left_analog_was_right = false;
-  bool right_analog_was_up = false;
-  bool right_analog_was_down = false;
-  bool right_analog_was_left = false;
-  bool right_analog_was_right = false;
-  bool a_hk_was_pressed = false;
-  bool b_hk_was_pressed = false;
-  bool x_hk_was_pressed = false;
-  bool y_hk_was_pressed = false;
-  bool l1_hk_was_pressed = false;
-  bool r1_hk_was_pressed = false;
-  bool l2_was_pressed = false;
-  bool l2_hk_was_pressed = false;
-  bool r2_was_pressed = false;
-  bool r2_hk_was_pressed = false;
-  bool hotkey_combo_triggered = false; //keep track of whether a hotkey combo was pressed; if so, don't send hotkey key when hotkey is released
-  bool start_combo_triggered = false; //keep track of whether a start combo was pressed; if so, don't send start key when start is released
-  short key_to_repeat = 0;
-  SDL_TimerID key_repeat_timer_id = 0;
-} state;
+  bool textinputinteractivetrigger_pressed = false; // to trigger text input interactive
+  bool textinputpresettrigger_pressed = false; // to trigger text input preset
+  bool textinputconfirmtrigger_pressed = false; // to trigger text input confirm via Enter key
+};
 
-struct
+pad_slot pads[PAD_SLOTS];
+Sint8 pad_slot_map[PAD_SLOT_MAP]; // index + 1 in pads, 0 for an empty entry
+
+#define TEXT_GRID_MAX_ROWS 12
+#define TEXT_GRID_MAX_COLUMNS 16
+
+enum mouse_curve_type
+{
+  MOUSE_CURVE_LINEAR,
+  MOUSE_CURVE_EXPONENTIAL,
+  MOUSE_CURVE_CUSTOM
+};
+
+struct config_settings
 {
-  short back = KEY_ESC;
-  bool back_repeat = false;
-  short back_modifier = 0;
-  short start = KEY_ENTER;
-  bool start_repeat = false;
-  short start_modifier = 0;
-  short guide = KEY_ENTER;
-  bool guide_repeat = false;
-  short guide_modifier = 0;
-  short a[12] = {KEY_X};
-  short a_hk[12] = {KEY_ENTER};
-  bool a_repeat = false;
-  short a_modifier[12] = {0};
-  short a_hk_modifier[12] = {0};
-  bool a_cycle = false;
-  int a_current_key = -1;
-  int a_total_keys = 0;
-  bool a_hk_cycle = false;
-  int a_hk_current_key = -1;
-  int a_hk_total_keys = 0;
-  short b[12] = {KEY_Z};
-  short b_hk[12] = {KEY_ESC};
-  bool b_repeat = false;
-  short b_modifier[12] = {0};
-  short b_hk_modifier[12] = {0};
-  bool b_cycle = false;
-  int b_current_key = -1;
-  int b_total_keys = 0;
-  bool b_hk_cycle = false;
-  int b_hk_current_key = -1;
-  int b_hk_total_keys = 0;
-  short x[12] = {KEY_C};
-  short x_hk[12] = {KEY_C};
-  bool x_repeat = false;
-  short x_modifier[12] = {0};
-  short x_hk_modifier[12] = {0};
-  bool x_cycle = false;
-  int x_current_key = -1;
-  int x_total_keys = 0;
-  bool x_hk_cycle = false;
-  int x_hk_current_key = -1;
-  int x_hk_total_keys = 0;
-  short y[12] = {KEY_A};
-  short y_hk[12] = {KEY_A};
-  bool y_repeat = false;
-  short y_modifier[12] = {0};
-  short y_hk_modifier[12] = {0};
-  bool y_cycle = false;
-  int y_current_key = -1;
-  int y_total_keys = 0;
-  bool y_hk_cycle = false;
-  int y_hk_current_key = -1;
-  int y_hk_total_keys = 0;
-  short l1[12] = {KEY_RIGHTSHIFT};
-  short l1_hk[12] = {KEY_ESC};
-  bool l1_repeat = false;
-  short l1_modifier[12] = {0};
-  short l1_hk_modifier[12] = {0};
-  bool l1_cycle = false;
-  int l1_current_key = -1;
-  int l1_total_keys = 0;
-  bool l1_hk_cycle = false;
-  int l1_hk_current_key = -1;
-  int l1_hk_total_keys = 0;
-  short l2 = KEY_HOME;
-  short l2_hk = KEY_HOME;
-  bool l2_repeat = false;
-  short l2_modifier = 0;
-  short l2_hk_modifier = 0;
-  short l3 = BTN_LEFT;
-  bool l3_repeat = false;
-  short l3_modifier = 0;
-  short r1[12] = {KEY_LEFTSHIFT};
-  short r1_hk[12] = {KEY_ENTER};
-  bool r1_repeat = false;
-  short r1_modifier[12] = {0};
-  short r1_hk_modifier[12] = {0};
-  bool r1_cycle = false;
-  int r1_current_key = -1;
-  int r1_total_keys = 0;
-  bool r1_hk_cycle = false;
-  int r1_hk_current_key = -1;
-  int r1_hk_total_keys = 0;
-  short r2 = KEY_END;
-  short r2_hk = KEY_END;
-  bool r2_repeat = false;
-  short r2_modifier = 0;
-  short r2_hk_modifier = 0;
-  short r3 = BTN_RIGHT;
-  bool r3_repeat = false;
-  short r3_modifier = 0;
-  short up = KEY_UP;
-  bool up_repeat = false;
-  short up_modifier = 0;
-  short down = KEY_DOWN;
-  bool down_repeat = false;
-  short down_modifier = 0;
-  short left = KEY_LEFT;
-  bool left_repeat = false;
-  short left_modifier = 0;
-  short right = KEY_RIGHT;
-  bool right_repeat = false;
-  short right_modifier = 0;
+  // what every input sends, on its own and with the hotkey held
+  binding bindings[BINDING_INPUTS][BINDING_LAYERS] = {
+    {defaultBinding(KEY_X), defaultBinding(KEY_ENTER)}, // a
+    {defaultBinding(KEY_Z), defaultBinding(KEY_ESC)}, // b
+    {defaultBinding(KEY_C), defaultBinding(KEY_C)}, // x
+    {defaultBinding(KEY_A), defaultBinding(KEY_A)}, // y
+    {defaultBinding(KEY_ESC), defaultBinding(0)}, // back
+    {defaultBinding(KEY_ENTER), defaultBinding(0)}, // guide
+    {defaultBinding(KEY_ENTER), defaultBinding(0)}, // start
+    {defaultBinding(BTN_LEFT), defaultBinding(0)}, // l3
+    {defaultBinding(BTN_RIGHT), defaultBinding(0)}, // r3
+    {defaultBinding(KEY_RIGHTSHIFT), defaultBinding(KEY_ESC)}, // l1
+    {defaultBinding(KEY_LEFTSHIFT), defaultBinding(KEY_ENTER)}, // r1
+    {defaultBinding(KEY_UP), defaultBinding(0)}, // up
+    {defaultBinding(KEY_DOWN), defaultBinding(0)}, // down
+    {defaultBinding(KEY_LEFT), defaultBinding(0)}, // left
+    {defaultBinding(KEY_RIGHT), defaultBinding(0)}, // right
+    {defaultBinding(KEY_W), defaultBinding(0)}, // left_analog_up
+    {defaultBinding(KEY_S), defaultBinding(0)}, // left_analog_down
+    {defaultBinding(KEY_A), defaultBinding(0)}, // left_analog_left
+    {defaultBinding(KEY_D), defaultBinding(0)}, // left_analog_right
+    {defaultBinding(KEY_END), defaultBinding(0)}, // right_analog_up
+    {defaultBinding(KEY_HOME), defaultBinding(0)}, // right_analog_down
+    {defaultBinding(KEY_LEFT), defaultBinding(0)}, // right_analog_left
+    {defaultBinding(KEY_RIGHT), defaultBinding(0)}, // right_analog_right
+    {defaultBinding(KEY_HOME), defaultBinding(KEY_HOME)}, // l2
+    {defaultBinding(KEY_END), defaultBinding(KEY_END)}, // r2
+  };
 
   bool left_analog_as_mouse = false;
   bool right_analog_as_mouse = false;
-  short left_analog_up = KEY_W;
-  bool left_analog_up_repeat = false;
-  short left_analog_up_modifier = 0;
-  short left_analog_down = KEY_S;
-  bool left_analog_down_repeat = false;
-  short left_analog_down_modifier = 0;
-  short left_analog_left = KEY_A;
-  bool left_analog_left_repeat = false;
-  short left_analog_left_modifier = 0;
-  short left_analog_right = KEY_D;
-  bool left_analog_right_repeat = false;
-  short left_analog_right_modifier = 0;
-  short right_analog_up = KEY_END;
-  bool right_analog_up_repeat = false;
-  short right_analog_up_modifier = 0;
-  short right_analog_down = KEY_HOME;
-  bool right_analog_down_repeat = false;
-  short right_analog_down_modifier = 0;
-  short right_analog_left = KEY_LEFT;
-  bool right_analog_left_repeat = false;
-  short right_analog_left_modifier = 0;
-  short right_analog_right = KEY_RIGHT;
-  bool right_analog_right_repeat = false;
-  short right_analog_right_modifier = 0;
+  bool left_analog_as_scroll = false;
+  bool right_analog_as_scroll = false;
 
   int deadzone_y = 15000;
   int deadzone_x = 15000;
   int deadzone_triggers = 3000;
 
   int fake_mouse_scale = 512;
+  int fake_mouse_scale_x = 0; // 0 uses fake_mouse_scale
+  int fake_mouse_scale_y = 0;
   int fake_mouse_delay = 16;
+  int fake_scroll_scale = 2048; // like fake_mouse_scale, in 1/120 of a wheel click
+  mouse_curve_type fake_mouse_curve = MOUSE_CURVE_LINEAR;
+  float fake_mouse_curve_exponent = 2.0f;
+  int fake_mouse_curve_points = 0;
+  Uint8 fake_mouse_curve_input[MOUSE_CURVE_MAX_POINTS]; // stick deflection in percent
+  Uint8 fake_mouse_curve_output[MOUSE_CURVE_MAX_POINTS]; // speed in percent of full deflection
 
   Uint32 key_repeat_interval = SDL_DEFAULT_REPEAT_INTERVAL * 2; 
   Uint32 key_repeat_delay = SDL_DEFAULT_REPEAT_DELAY; 
-  
-  char* text_input_preset;
+  Uint32 text_input_delay = 16; // how long a typed key is held, and the pause after it
+  char text_input_grid[TEXT_GRID_MAX_ROWS][TEXT_GRID_MAX_COLUMNS + 1] = {}; // virtual keyboard rows for interactive text input
+  int text_input_grid_rows = 0; // 0 scrolls through the characters in a line instead
+  Uint32 text_input_refresh = 0; // shortest time between characters shown while scrolling in interactive text input, 0 shows every one
 } config;
 
-// convert ASCII chars to key codes
-short char_to_keycode(const char* str)
+// compile time checks that a name table is sorted, split in halves to keep the recursion shallow
+constexpr bool nameLess(const char* a, const char* b)
 {
-  short keycode;
-
-  // arrow keys
-  if (strcmp(str, "up") == 0)
-    keycode = KEY_UP;
-  else if (strcmp(str, "down") == 0)
-    keycode = KEY_DOWN;
-  else if (strcmp(str, "left") == 0)
-    keycode = KEY_LEFT;
-  else if (strcmp(str, "right") == 0)
-    keycode = KEY_RIGHT;
-
-  // special keys
-  else if (strcmp(str, "mouse_left") == 0)
-    keycode = BTN_LEFT;
-  else if (strcmp(str, "mouse_right") == 0)
-    keycode = BTN_RIGHT;
-  else if (strcmp(str, "space") == 0)
-    keycode = KEY_SPACE;
-  else if (strcmp(str, "esc") == 0)
-    keycode = KEY_ESC;
-  else if (strcmp(str, "end") == 0)
-    keycode = KEY_END;
-  else if (strcmp(str, "home") == 0)
-    keycode = KEY_HOME;
-  else if (strcmp(str, "shift") == 0)
-    keycode = KEY_LEFTSHIFT;
-  else if (strcmp(str, "leftshift") == 0)
-    keycode = KEY_LEFTSHIFT;
-  else if (strcmp(str, "rightshift") == 0)
-    keycode = KEY_RIGHTSHIFT;
-  else if (strcmp(str, "ctrl") == 0)
-    keycode = KEY_LEFTCTRL;
-  else if (strcmp(str, "leftctrl") == 0)
-    keycode = KEY_LEFTCTRL;
-  else if (strcmp(str, "rightctrl") == 0)
-    keycode = KEY_RIGHTCTRL;
-  else if (strcmp(str, "alt") == 0)
-    keycode = KEY_LEFTALT;
-  else if (strcmp(str, "leftalt") == 0)
-    keycode = KEY_LEFTALT;
-  else if (strcmp(str, "rightalt") == 0)
-    keycode = KEY_RIGHTALT;
-  else if (strcmp(str, "backspace") == 0)
-    keycode = KEY_BACKSPACE;
-  else if (strcmp(str, "enter") == 0)
-    keycode = KEY_ENTER;
-  else if (strcmp(str, "pageup") == 0)
-    keycode = KEY_PAGEUP;
-  else if (strcmp(str, "pagedown") == 0)
-    keycode = KEY_PAGEDOWN;
-  else if (strcmp(str, "insert") == 0)
-    keycode = KEY_INSERT;
-  else if (strcmp(str, "delete") == 0)
-    keycode = KEY_DELETE;
-  else if (strcmp(str, "capslock") == 0)
-    keycode = KEY_CAPSLOCK;
-  else if (strcmp(str, "tab") == 0)
-    keycode = KEY_TAB;
-  else if (strcmp(str, "pause") == 0)
-    keycode = KEY_PAUSE;
-  else if (strcmp(str, "menu") == 0)
-    keycode = KEY_MENU;
-    
-  // normal keyboard
-  else if (strcmp(str, "a") == 0)
-    keycode = KEY_A;
-  else if (strcmp(str, "b") == 0)
-    keycode = KEY_B;
-  else if (strcmp(str, "c") == 0)
-    keycode = KEY_C;
-  else if (strcmp(str, "d") == 0)
-    keycode = KEY_D;
-  else if (strcmp(str, "e") == 0)
-    keycode = KEY_E;
-  else if (strcmp(str, "f") == 0)
-    keycode = KEY_F;
-  else if (strcmp(str, "g") == 0)
-    keycode = KEY_G;
-  else if (strcmp(str, "h") == 0)
-    keycode = KEY_H;
-  else if (strcmp(str, "i") == 0)
-    keycode = KEY_I;
-  else if (strcmp(str, "j") == 0)
-    keycode = KEY_J;
-  else if (strcmp(str, "k") == 0)
-    keycode = KEY_K;
-  else if (strcmp(str, "l") == 0)
-    keycode = KEY_L;
-  else if (strcmp(str, "m") == 0)
-    keycode = KEY_M;
-  else if (strcmp(str, "n") == 0)
-    keycode = KEY_N;
-  else if (strcmp(str, "o") == 0)
-    keycode = KEY_O;
-  else if (strcmp(str, "p") == 0)
-    keycode = KEY_P;
-  else if (strcmp(str, "q") == 0)
-    keycode = KEY_Q;
-  else if (strcmp(str, "r") == 0)
-    keycode = KEY_R;
-  else if (strcmp(str, "s") == 0)
-    keycode = KEY_S;
-  else if (strcmp(str, "t") == 0)
-    keycode = KEY_T;
-  else if (strcmp(str, "u") == 0)
-    keycode = KEY_U;
-  else if (strcmp(str, "v") == 0)
-    keycode = KEY_V;
-  else if (strcmp(str, "w") == 0)
-    keycode = KEY_W;
-  else if (strcmp(str, "x") == 0)
-    keycode = KEY_X;
-  else if (strcmp(str, "y") == 0)
-    keycode = KEY_Y;
-  else if (strcmp(str, "z") == 0)
-    keycode = KEY_Z;
-
-  else if (strcmp(str, "1") == 0)
-    keycode = KEY_1;
-  else if (strcmp(str, "2") == 0)
-    keycode = KEY_2;
-  else if (strcmp(str, "3") == 0)
-    keycode = KEY_3;
-  else if (strcmp(str, "4") == 0)
-    keycode = KEY_4;
-  else if (strcmp(str, "5") == 0)
-    keycode = KEY_5;
-  else if (strcmp(str, "6") == 0)
-    keycode = KEY_6;
-  else if (strcmp(str, "7") == 0)
-    keycode = KEY_7;
-  else if (strcmp(str, "8") == 0)
-    keycode = KEY_8;
-  else if (strcmp(str, "9") == 0)
-    keycode = KEY_9;
-  else if (strcmp(str, "0") == 0)
-    keycode = KEY_0;
-
-  else if (strcmp(str, "f1") == 0)
-    keycode = KEY_F1;
-  else if (strcmp(str, "f2") == 0)
-    keycode = KEY_F2;
-  else if (strcmp(str, "f3") == 0)
-    keycode = KEY_F3;
-  else if (strcmp(str, "f4") == 0)
-    keycode = KEY_F4;
-  else if (strcmp(str, "f5") == 0)
-    keycode = KEY_F5;
-  else if (strcmp(str, "f6") == 0)
-    keycode = KEY_F6;
-  else if (strcmp(str, "f7") == 0)
-    keycode = KEY_F7;
-  else if (strcmp(str, "f8") == 0)
-    keycode = KEY_F8;
-  else if (strcmp(str, "f9") == 0)
-    keycode = KEY_F9;
-  else if (strcmp(str, "f10") == 0)
-    keycode = KEY_F10;
-  else if (strcmp(str, "f11") == 0)
-    keycode = KEY_F11;
-  else if (strcmp(str, "f12") == 0)
-    keycode = KEY_F12;
-
-  else if (strcmp(str, "@") == 0)
-    keycode = KEY_2; // with SHIFT
-  else if (strcmp(str, "#") == 0)
-    keycode = KEY_3; // with SHIFT
-  //else if (strcmp(str, "€") == 0) keycode = KEY_5; // with ALTGR; not ASCII
-  else if (strcmp(str, "%") == 0)
-    keycode = KEY_5; // with SHIFT
-  else if (strcmp(str, "&") == 0)
-    keycode = KEY_7; // with SHIFT
-  else if (strcmp(str, "*") == 0)
-    keycode = KEY_8; // with SHIFT; alternative is KEY_KPASTERISK
-  else if (strcmp(str, "-") == 0)
-    keycode = KEY_MINUS; // alternative is KEY_KPMINUS
-  else if (strcmp(str, "+") == 0)
-    keycode = KEY_EQUAL; // with SHIFT; alternative is KEY_KPPLUS
-  else if (strcmp(str, "(") == 0)
-    keycode = KEY_9; // with SHIFT
-  else if (strcmp(str, ")") == 0)
-    keycode = KEY_0; // with SHIFT
-
-  else if (strcmp(str, "!") == 0)
-    keycode = KEY_1; // with SHIFT
-  else if (strcmp(str, "\"") == 0)
-    keycode = KEY_APOSTROPHE; // with SHIFT, dead key
-  else if (strcmp(str, "\'") == 0)
-    keycode = KEY_APOSTROPHE; // dead key
-  else if (strcmp(str, ":") == 0)
-    keycode = KEY_SEMICOLON; // with SHIFT
-  else if (strcmp(str, ";") == 0)
-    keycode = KEY_SEMICOLON;
-  else if (strcmp(str, "/") == 0)
-    keycode = KEY_SLASH;
-  else if (strcmp(str, "?") == 0)
-    keycode = KEY_SLASH; // with SHIFT
-  else if (strcmp(str, ".") == 0)
-    keycode = KEY_DOT;
-  else if (strcmp(str, ",") == 0)
-    keycode = KEY_COMMA;
-
-  // special chars
-  else if (strcmp(str, "~") == 0)
-    keycode = KEY_GRAVE; // with SHIFT, dead key
-  else if (strcmp(str, "`") == 0)
-    keycode = KEY_GRAVE; // dead key
-  else if (strcmp(str, "|") == 0)
-    keycode = KEY_BACKSLASH; // with SHIFT
-  else if (strcmp(str, "{") == 0)
-    keycode = KEY_LEFTBRACE; // with SHIFT
-  else if (strcmp(str, "}") == 0)
-    keycode = KEY_RIGHTBRACE; // with SHIFT
-  else if (strcmp(str, "$") == 0)
-    keycode = KEY_4; // with SHIFT
-  else if (strcmp(str, "^") == 0)
-    keycode = KEY_6; // with SHIFT, dead key
-  else if (strcmp(str, "_") == 0)
-    keycode = KEY_MINUS; // with SHIFT
-  else if (strcmp(str, "=") == 0)
-    keycode = KEY_EQUAL;
-  else if (strcmp(str, "[") == 0)
-    keycode = KEY_LEFTBRACE;
-  else if (strcmp(str, "]") == 0)
-    keycode = KEY_RIGHTBRACE;
-  else if (strcmp(str, "\\") == 0)
-    keycode = KEY_BACKSLASH;
-  else if (strcmp(str, "<") == 0)
-    keycode = KEY_COMMA; // with SHIFT
-  else if (strcmp(str, ">") == 0)
-    keycode = KEY_DOT; // with SHIFT
-
-  return keycode;
+  return (*a == *b) ? ((*a != '\0') && nameLess(a + 1, b + 1)) : ((unsigned char)*a < (unsigned char)*b);
 }
 
-void initialiseCharacters()
+template <typename Entry>
+constexpr bool namesSorted(const Entry* table, size_t begin, size_t end)
 {
-  if (textinputinteractive_noautocapitals) {
-    current_key[0] = 26; // if environment variable has been set to disable capitalisation of first characters start with all lower case  
-  } else {
-    current_key[0] = 0; // otherwise start with upper case for 1st character
-  }
-  for (int ii = 1; ii < maxChars; ii++) { // start with lower case for other character onwards
-    current_key[ii] = 26;
-  }
-
+  return (end - begin < 2) ? true :
+    (end - begin == 2) ? nameLess(table[begin].name, table[begin + 1].name) :
+    namesSorted(table, begin, (begin + end) / 2 + 1) && namesSorted(table, (begin + end) / 2, end);
 }
 
-void initialiseCharacterSet()
+template <typename Entry>
+constexpr bool codesSorted(const Entry* table, size_t begin, size_t end)
 {
-  character_set[0]=char_to_keycode("a"); //capital letters
-  character_set_shift[0]=true;
-  character_set[1]=char_to_keycode("b");
-  character_set_shift[1]=true;
-  character_set[2]=char_to_keycode("c");
-  character_set_shift[2]=true;
-  character_set[3]=char_to_keycode("d");
-  character_set_shift[3]=true;
-  character_set[4]=char_to_keycode("e");
-  character_set_shift[4]=true;
-  character_set[5]=char_to_keycode("f");
-  character_set_shift[5]=true;
-  character_set[6]=char_to_keycode("g");
-  character_set_shift[6]=true;
-  character_set[7]=char_to_keycode("h");
-  character_set_shift[7]=true;
-  character_set[8]=char_to_keycode("i");
-  character_set_shift[8]=true;
-  character_set[9]=char_to_keycode("j");
-  character_set_shift[9]=true;
-  character_set[10]=char_to_keycode("k");
-  character_set_shift[10]=true;
-  character_set[11]=char_to_keycode("l");
-  character_set_shift[11]=true;
-  character_set[12]=char_to_keycode("m");
-  character_set_shift[12]=true;
-  character_set[13]=char_to_keycode("n");
-  character_set_shift[13]=true;
-  character_set[14]=char_to_keycode("o");
-  character_set_shift[14]=true;
-  character_set[15]=char_to_keycode("p");
-  character_set_shift[15]=true;
-  character_set[16]=char_to_keycode("q");
-  character_set_shift[16]=true;
-  character_set[17]=char_to_keycode("r");
-  character_set_shift[17]=true;
-  character_set[18]=char_to_keycode("s");
-  character_set_shift[18]=true;
-  character_set[19]=char_to_keycode("t");
-  character_set_shift[19]=true;
-  character_set[20]=char_to_keycode("u");
-  character_set_shift[20]=true;
-  character_set[21]=char_to_keycode("v");
-  character_set_shift[21]=true;
-  character_set[22]=char_to_keycode("w");
-  character_set_shift[22]=true;
-  character_set[23]=char_to_keycode("x");
-  character_set_shift[23]=true;
-  character_set[24]=char_to_keycode("y");
-  character_set_shift[24]=true;
-  character_set[25]=char_to_keycode("z");
-  character_set_shift[25]=true;
-  character_set[26]=char_to_keycode("a"); //lower case
-  character_set_shift[26]=false;
-  character_set[27]=char_to_keycode("b");
-  character_set_shift[27]=false;
-  character_set[28]=char_to_keycode("c");
-  character_set_shift[28]=false;
-  character_set[29]=char_to_keycode("d");
-  character_set_shift[29]=false;
-  character_set[30]=char_to_keycode("e");
-  character_set_shift[30]=false;  
-  character_set[31]=char_to_keycode("f");
-  character_set_shift[31]=false;
-  character_set[32]=char_to_keycode("g");
-  character_set_shift[32]=false;
-  character_set[33]=char_to_keycode("h");
-  character_set_shift[33]=false;
-  character_set[34]=char_to_keycode("i");
-  character_set_shift[34]=false;
-  character_set[35]=char_to_keycode("j");
-  character_set_shift[35]=false;
-  character_set[36]=char_to_keycode("k");
-  character_set_shift[36]=false;
-  character_set[37]=char_to_keycode("l");
-  character_set_shift[37]=false;
-  character_set[38]=char_to_keycode("m");
-  character_set_shift[38]=false;
-  character_set[39]=char_to_keycode("n");
-  character_set_shift[39]=false;
-  character_set[40]=char_to_keycode("o");
-  character_set_shift[40]=false;
-  character_set[41]=char_to_keycode("p");
-  character_set_shift[41]=false;
-  character_set[42]=char_to_keycode("q");
-  character_set_shift[42]=false;
-  character_set[43]=char_to_keycode("r");
-  character_set_shift[43]=false;
-  character_set[44]=char_to_keycode("s");
-  character_set_shift[44]=false;
-  character_set[45]=char_to_keycode("t");
-  character_set_shift[45]=false;
-  character_set[46]=char_to_keycode("u");
-  character_set_shift[46]=false;
-  character_set[47]=char_to_keycode("v");
-  character_set_shift[47]=false;
-  character_set[48]=char_to_keycode("w");
-  character_set_shift[48]=false;
-  character_set[49]=char_to_keycode("x");
-  character_set_shift[49]=false;
-  character_set[50]=char_to_keycode("y");
-  character_set_shift[50]=false;
-  character_set[51]=char_to_keycode("z");
-  character_set_shift[51]=false;
-  character_set[52]=char_to_keycode("0");
-  character_set_shift[52]=false;
-  character_set[53]=char_to_keycode("1");
-  character_set_shift[53]=false;
-  character_set[54]=char_to_keycode("2");
-  character_set_shift[54]=false;
-  character_set[55]=char_to_keycode("3");
-  character_set_shift[55]=false;
-  character_set[56]=char_to_keycode("4");
-  character_set_shift[56]=false;
-  character_set[57]=char_to_keycode("5");
-  character_set_shift[57]=false;
-  character_set[58]=char_to_keycode("6");
-  character_set_shift[58]=false;
-  character_set[59]=char_to_keycode("7"); 
-  character_set_shift[59]=false;
-  character_set[60]=char_to_keycode("8"); 
-  character_set_shift[60]=false;
-  character_set[61]=char_to_keycode("9"); 
-  character_set_shift[61]=false;
-  character_set[62]=char_to_keycode("space"); 
-  character_set_shift[62]=false;
-  character_set[63]=char_to_keycode("."); 
-  character_set_shift[63]=false;
-  character_set[64]=char_to_keycode(","); 
-  character_set_shift[64]=false;
-  character_set[65]=char_to_keycode("-"); 
-  character_set_shift[65]=false;
-  character_set[66]=char_to_keycode("_"); 
-  character_set_shift[66]=true;
-  character_set[67]=char_to_keycode("("); 
-  character_set_shift[67]=true;
-  character_set[68]=char_to_keycode(")");  
-  character_set_shift[68]=true;
+  return (end - begin < 2) ? true :
+    (end - begin == 2) ? (table[begin].code < table[begin + 1].code) :
+    codesSorted(table, begin, (begin + end) / 2 + 1) && codesSorted(table, (begin + end) / 2, end);
+}
 
-  if (textinputinteractive_extrasymbols) {
-    maxKeys = maxKeysWithSymbols;
-    character_set[69]=char_to_keycode("@");  
-    character_set_shift[69]=true;
-    character_set[70]=char_to_keycode("#");  
-    character_set_shift[70]=true;
-    character_set[71]=char_to_keycode("%");  
-    character_set_shift[71]=true;
-    character_set[72]=char_to_keycode("&");  
-    character_set_shift[72]=true;
-    character_set[73]=char_to_keycode("*");  
-    character_set_shift[73]=true;
-    character_set[74]=char_to_keycode("-");  
-    character_set_shift[74]=false;
-    character_set[75]=char_to_keycode("+");  
-    character_set_shift[75]=true;
-    character_set[76]=char_to_keycode("!");  
-    character_set_shift[76]=true;
-    character_set[77]=char_to_keycode("\"");  
-    character_set_shift[77]=true;
-    character_set[78]=char_to_keycode("\'");  
-    character_set_shift[78]=false;
-    character_set[79]=char_to_keycode(":");  
-    character_set_shift[79]=true;
-    character_set[80]=char_to_keycode(";");  
-    character_set_shift[80]=false;
-    character_set[81]=char_to_keycode("/");  
-    character_set_shift[81]=false;
-    character_set[82]=char_to_keycode("?");  
-    character_set_shift[82]=true;
-    character_set[83]=char_to_keycode("~");  
-    character_set_shift[83]=true;
-    character_set[84]=char_to_keycode("`");  
-    character_set_shift[84]=false;
-    character_set[85]=char_to_keycode("|");  
-    character_set_shift[85]=true;
-    character_set[86]=char_to_keycode("{");  
-    character_set_shift[86]=true;
-    character_set[87]=char_to_keycode("}");  
-    character_set_shift[87]=true;
-    character_set[88]=char_to_keycode("$");  
-    character_set_shift[88]=true;
-    character_set[89]=char_to_keycode("^");  
-    character_set_shift[89]=true;
-    character_set[90]=char_to_keycode("=");  
-    character_set_shift[90]=false;
-    character_set[91]=char_to_keycode("[");  
-    character_set_shift[91]=false;
-    character_set[92]=char_to_keycode("]");  
-    character_set_shift[92]=false;
-    character_set[93]=char_to_keycode("\\");  
-    character_set_shift[93]=false;
-    character_set[94]=char_to_keycode("<");  
-    character_set_shift[94]=true;
-    character_set[95]=char_to_keycode(">");  
-    character_set_shift[95]=true;
+#define TABLE_SIZE(table) (sizeof(table) / sizeof(table[0]))
+
+static_assert(namesSorted(keycode_names, 0, TABLE_SIZE(keycode_names)), "keycode_names must be sorted by name");
+static_assert(codesSorted(keycode_canonical_names, 0, TABLE_SIZE(keycode_canonical_names)), "keycode_canonical_names must be sorted by code");
+
+// binary search of a table sorted by name, NULL if the name is not in it
+template <typename Entry, size_t Size>
+const Entry* findByName(const Entry (&table)[Size], const char* name)
+{
+  const Entry* entry = std::lower_bound(table, table + Size, name, [](const Entry& candidate, const char* wanted) {
+    return strcmp(candidate.name, wanted) < 0;
+  });
+  if ((entry == table + Size) || (strcmp(entry->name, name) != 0)) {
+    return NULL;
   }
-  initialiseCharacters();
+  return entry;
 }
 
-void readConfigFile(const char* config_file)
+int config_errors = 0; // unknown key names and invalid values in the config being read, a reload with any is rejected
+
+// convert key names and ASCII chars to key codes, 0 (KEY_RESERVED) if the name is unknown
+short char_to_keycode(const char* str)
 {
-  const auto parsedConfig = parseConfigFile(config_file);
-  for (const auto& co : parsedConfig) {
-    if (strcmp(co.key, "back") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.back_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.back_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.back_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.back_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.back = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "guide") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.guide_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.guide_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.guide_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.guide_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.guide = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "start") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.start_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.start_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.start_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.start_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.start = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "a") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.a_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.a_modifier[config.a_current_key] = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.a_modifier[config.a_current_key] = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.a_modifier[config.a_current_key] = KEY_LEFTSHIFT;
-        } else {
-            config.a_total_keys++;
-            if (config.a_total_keys > 1) {
-                config.a_cycle = true;
-	    }
-            if (config.a_total_keys <= 12) {
-		config.a[config.a_total_keys - 1] = char_to_keycode(co.value);
-	    } else {
-		printf("A button has too many key assignments\n");
-	    }
-	    config.a_total_keys = std::min(config.a_total_keys,12);
-        }
-    } else if (strcmp(co.key, "a_hk") == 0) {
-        if (strcmp(co.value, "add_alt") == 0) {
-            config.a_hk_modifier[config.a_hk_current_key] = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.a_hk_modifier[config.a_hk_current_key] = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.a_hk_modifier[config.a_hk_current_key] = KEY_LEFTSHIFT;
-        } else {
-            config.a_hk_total_keys++;
-            if (config.a_hk_total_keys > 1) {
-                config.a_hk_cycle = true;
-	    }
-            if (config.a_hk_total_keys <= 12) {
-		config.a_hk[config.a_hk_total_keys - 1] = char_to_keycode(co.value);
-	    } else {
-		printf("A + hotkey button has too many key assignments\n");
-	    }
-	    config.a_hk_total_keys = std::min(config.a_hk_total_keys,12);
-        }
-    } else if (strcmp(co.key, "b") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.b_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.b_modifier[config.b_current_key] = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.b_modifier[config.b_current_key] = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.b_modifier[config.b_current_key] = KEY_LEFTSHIFT;
-        } else {
-            config.b_total_keys++;
-            if (config.b_total_keys > 1) {
-                config.b_cycle = true;
-	    }
-            if (config.b_total_keys <= 12) {
-		config.b[config.b_total_keys - 1] = char_to_keycode(co.value);
-	    } else {
-		printf("B button has too many key assignments\n");
-	    }
-	    config.b_total_keys = std::min(config.b_total_keys,12);
-        }
-    } else if (strcmp(co.key, "b_hk") == 0) {
-        if (strcmp(co.value, "add_alt") == 0) {
-            config.b_hk_modifier[config.b_hk_current_key] = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.b_hk_modifier[config.b_hk_current_key] = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.b_hk_modifier[config.b_hk_current_key] = KEY_LEFTSHIFT;
-        } else {
-            config.b_hk_total_keys++;
-            if (config.b_hk_total_keys > 1) {
-                config.b_hk_cycle = true;
-	    }
-            if (config.b_hk_total_keys <= 12) {
-		config.b_hk[config.b_hk_total_keys - 1] = char_to_keycode(co.value);
-	    } else {
-		printf("B + hotkey button has too many key assignments\n");
-	    }
-	    config.b_hk_total_keys = std::min(config.b_hk_total_keys,12);
-        }
-    } else if (strcmp(co.key, "x") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.x_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.x_modifier[config.x_current_key] = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.x_modifier[config.x_current_key] = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.x_modifier[config.x_current_key] = KEY_LEFTSHIFT;
-        } else {
-            config.x_total_keys++;
-            if (config.x_total_keys > 1) {
-                config.x_cycle = true;
-            }
-            if (config.x_total_keys <= 12) {
-		config.x[config.x_total_keys - 1] = char_to_keycode(co.value);
-	    } else {
-	    	printf("X button has too many key assignments\n");
-	    }
-	    config.x_total_keys = std::min(config.x_total_keys,12);
-        }
-    } else if (strcmp(co.key, "x_hk") == 0) {
-        if (strcmp(co.value, "add_alt") == 0) {
-            config.x_hk_modifier[config.x_hk_current_key] = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.x_hk_modifier[config.x_hk_current_key] = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.x_hk_modifier[config.x_hk_current_key] = KEY_LEFTSHIFT;
-        } else {
-            config.x_hk_total_keys++;
-            if (config.x_hk_total_keys > 1) {
-                config.x_hk_cycle = true;
-            }
-            if (config.x_hk_total_keys <= 12) {
-	    	config.x_hk[config.x_hk_total_keys - 1] = char_to_keycode(co.value);
-	    } else {
-	    	printf("X + hotkey button has too many key assignments\n");
-	    }
-	    config.x_hk_total_keys = std::min(config.x_hk_total_keys,12);
-        }
-    } else if (strcmp(co.key, "y") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.y_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.y_modifier[config.y_current_key] = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.y_modifier[config.y_current_key] = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.y_modifier[config.y_current_key] = KEY_LEFTSHIFT;
-        } else {
-            config.y_total_keys++;
-            if (config.y_total_keys > 1) {
-                config.y_cycle = true;
-            }
-            if (config.y_total_keys <= 12) {
-	    	config.y[config.y_total_keys - 1] = char_to_keycode(co.value);
-	    } else {
-	    	printf("Y button has too many key assignments\n");
-	    }
-	    config.y_total_keys = std::min(config.y_total_keys,12);
-        }
-    } else if (strcmp(co.key, "y_hk") == 0) {
-        if (strcmp(co.value, "add_alt") == 0) {
-            config.y_hk_modifier[config.y_hk_current_key] = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.y_hk_modifier[config.y_hk_current_key] = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.y_hk_modifier[config.y_hk_current_key] = KEY_LEFTSHIFT;
-        } else {
-            config.y_hk_total_keys++;
-            if (config.y_hk_total_keys > 1) {
-                config.y_hk_cycle = true;
-            }
-            if (config.y_hk_total_keys <= 12) {
-	    	config.y_hk[config.y_hk_total_keys - 1] = char_to_keycode(co.value);
-	    } else {
-	    	printf("Y + hotkey button has too many key assignments\n");
-	    }
-	    config.y_hk_total_keys = std::min(config.y_hk_total_keys,12);
-        }
-    } else if (strcmp(co.key, "l1") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.l1_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.l1_modifier[config.l1_current_key] = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.l1_modifier[config.l1_current_key] = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.l1_modifier[config.l1_current_key] = KEY_LEFTSHIFT;
-        } else {
-            config.l1_total_keys++;
-            if (config.l1_total_keys > 1) {
-                config.l1_cycle = true;
-            }
-            if (config.l1_total_keys <= 12) {
-	    	config.l1[config.l1_total_keys - 1] = char_to_keycode(co.value);
-	    } else {
-	    	printf("L1 button has too many key assignments\n");
-	    }
-	    config.l1_total_keys = std::min(config.l1_total_keys,12);
-        }
-    } else if (strcmp(co.key, "l1_hk") == 0) {
-        if (strcmp(co.value, "add_alt") == 0) {
-            config.l1_hk_modifier[config.l1_hk_current_key] = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.l1_hk_modifier[config.l1_hk_current_key] = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.l1_hk_modifier[config.l1_hk_current_key] = KEY_LEFTSHIFT;
-        } else {
-            config.l1_hk_total_keys++;
-            if (config.l1_hk_total_keys > 1) {
-                config.l1_hk_cycle = true;
-            }
-            if (config.l1_hk_total_keys <= 12) {
-		config.l1_hk[config.l1_hk_total_keys - 1] = char_to_keycode(co.value);
-	    } else {
-		printf("L1 + hotkey button has too many key assignments\n");
-	    }
-	    config.l1_hk_total_keys = std::min(config.l1_hk_total_keys,12);
-        }
-    } else if (strcmp(co.key, "l2") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.l2_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.l2_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.l2_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.l2_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.l2 = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "l2_hk") == 0) {
-        if (strcmp(co.value, "add_alt") == 0) {
-            config.l2_hk_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.l2_hk_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.l2_hk_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.l2_hk = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "l3") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.l3_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.l3_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.l3_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.l3_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.l3 = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "r1") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.r1_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.r1_modifier[config.r1_current_key] = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.r1_modifier[config.r1_current_key] = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.r1_modifier[config.r1_current_key] = KEY_LEFTSHIFT;
-        } else {
-           config.r1_total_keys++;
-            if (config.r1_total_keys > 1) {
-                config.r1_cycle = true;
-            }
-            if (config.r1_total_keys <= 12) {
-		config.r1[config.r1_total_keys - 1] = char_to_keycode(co.value);
-	    } else {
-		printf("R1 button has too many key assignments\n");
-	    }
-	    config.r1_total_keys = std::min(config.r1_total_keys,12);
-        }
-    } else if (strcmp(co.key, "r1_hk") == 0) {
-        if (strcmp(co.value, "add_alt") == 0) {
-            config.r1_hk_modifier[config.r1_hk_current_key] = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.r1_hk_modifier[config.r1_hk_current_key] = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.r1_hk_modifier[config.r1_hk_current_key] = KEY_LEFTSHIFT;
-        } else {
-            config.r1_hk_total_keys++;
-            if (config.r1_hk_total_keys > 1) {
-                config.r1_hk_cycle = true;
-            }
-            if (config.r1_hk_total_keys <= 12) {
-		config.r1_hk[config.r1_hk_total_keys - 1] = char_to_keycode(co.value);
-	    } else {
-		printf("R1 + hotkey button has too many key assignments\n");
-	    }
-	    config.r1_hk_total_keys = std::min(config.r1_hk_total_keys,12);
-        }
-    } else if (strcmp(co.key, "r2") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.r2_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.r2_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.r2_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.r2_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.r2 = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "r2_hk") == 0) {
-        if (strcmp(co.value, "add_alt") == 0) {
-            config.r2_hk_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.r2_hk_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.r2_hk_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.r2_hk = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "r3") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.r3_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.r3_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.r3_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.r3_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.r3 = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "up") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.up_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.up_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.up_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.up_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.up = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "down") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.down_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.down_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.down_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.down_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.down = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "left") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.left_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.left_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.left_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.left_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.left = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "right") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.right_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.right_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.right_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.right_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.right = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "left_analog_up") == 0) {
-      if (strcmp(co.value, "mouse_movement_up") == 0) {
-        config.left_analog_as_mouse = true;
-      } else {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.left_analog_up_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.left_analog_up_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.left_analog_up_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.left_analog_up_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.left_analog_up = char_to_keycode(co.value);
-        }
-      }
-    } else if (strcmp(co.key, "left_analog_down") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.left_analog_down_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.left_analog_down_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.left_analog_down_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.left_analog_down_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.left_analog_down = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "left_analog_left") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.left_analog_left_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.left_analog_left_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.left_analog_left_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.left_analog_left_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.left_analog_left = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "left_analog_right") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.left_analog_right_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.left_analog_right_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.left_analog_right_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.left_analog_right_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.left_analog_right = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "right_analog_up") == 0) {
-      if (strcmp(co.value, "mouse_movement_up") == 0) {
-        config.right_analog_as_mouse = true;
-      } else {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.right_analog_up_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.right_analog_up_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.right_analog_up_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.right_analog_up_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.right_analog_up = char_to_keycode(co.value);
-        }
-      }
-    } else if (strcmp(co.key, "right_analog_down") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.right_analog_down_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.right_analog_down_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.right_analog_down_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.right_analog_down_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.right_analog_down = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "right_analog_left") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.right_analog_left_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.right_analog_left_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.right_analog_left_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.right_analog_left_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.right_analog_left = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "right_analog_right") == 0) {
-        if (strcmp(co.value, "repeat") == 0) {
-            config.right_analog_right_repeat = true;
-        } else if (strcmp(co.value, "add_alt") == 0) {
-            config.right_analog_right_modifier = KEY_LEFTALT;
-        } else if (strcmp(co.value, "add_ctrl") == 0) {
-            config.right_analog_right_modifier = KEY_LEFTCTRL;
-        } else if (strcmp(co.value, "add_shift") == 0) {
-            config.right_analog_right_modifier = KEY_LEFTSHIFT;
-        } else {
-            config.right_analog_right = char_to_keycode(co.value);
-        }
-    } else if (strcmp(co.key, "deadzone_y") == 0) {
-      config.deadzone_y = atoi(co.value);
-    } else if (strcmp(co.key, "deadzone_x") == 0) {
-      config.deadzone_x = atoi(co.value);
-    } else if (strcmp(co.key, "deadzone_triggers") == 0) {
-      config.deadzone_triggers = atoi(co.value);
-    } else if (strcmp(co.key, "mouse_scale") == 0) {
-      config.fake_mouse_scale = atoi(co.value);
-    } else if (strcmp(co.key, "mouse_delay") == 0) {
-      config.fake_mouse_delay = atoi(co.value);
-    } else if (strcmp(co.key, "repeat_delay") == 0) {
-      config.key_repeat_delay = atoi(co.value);
-    } else if (strcmp(co.key, "repeat_interval") == 0) {
-      config.key_repeat_interval = atoi(co.value);
-    } 
+  if (const keycode_name* entry = findByName(keycode_names, str)) {
+    return entry->code;
+  }
+  if (strcmp(str, "\\\"") != 0) { // `button = \"` is the documented way to unassign a button
+    printf("unknown key name %s\n", str);
+    config_errors++;
   }
+  return 0;
 }
 
-int applyDeadzone(int value, int deadzone)
+// name of a key code for diagnostics
+const char* keycode_to_name(int code)
 {
-  if (std::abs(value) > deadzone) {
-    return value;
-  } else {
-    return 0;
+  const keycode_name* end = keycode_canonical_names + TABLE_SIZE(keycode_canonical_names);
+  const keycode_name* entry = std::lower_bound(keycode_canonical_names, end, code, [](const keycode_name& candidate, int wanted) {
+    return candidate.code < wanted;
+  });
+  if ((entry == end) || (entry->code != code)) {
+    return "unknown";
   }
+  return entry->name;
 }
 
-void UINPUT_SET_ABS_P(
-  uinput_user_dev* dev,
-  int axis,
-  int min,
-  int max,
-  int fuzz,
-  int flat)
+// text is typed through a 128 entry table from ASCII to key code and modifiers, built from the
+// keyboard layout the system interprets the fake keyboard's key codes with (TEXTINPUTLAYOUT)
+#define TEXT_MOD_SHIFT 1
+#define TEXT_MOD_ALTGR 2
+
+struct text_key
 {
-  dev->absmax[axis] = max;
-  dev->absmin[axis] = min;
-  dev->absfuzz[axis] = fuzz;
-  dev->absflat[axis] = flat;
-}
+  Uint8 code; // 0 when the layout has no key for the character
+  Uint8 modifiers; // TEXT_MOD_*
+};
 
-void emit(int type, int code, int val)
+// characters outside ASCII that a layout types directly
+struct text_key_extra
 {
-  struct input_event ev;
+  Uint32 codepoint;
+  text_key key;
+};
 
-  ev.type = type;
-  ev.code = code;
-  ev.value = val;
-  /* timestamp values below are ignored */
-  ev.time.tv_sec = 0;
-  ev.time.tv_usec = 0;
+// each level lists the character of every key in layout_key_codes, ' ' where it has none (or a dead key)
+#define LAYOUT_KEYS 48
+
+const Uint8 layout_key_codes[LAYOUT_KEYS] = {
+  KEY_GRAVE, KEY_1, KEY_2, KEY_3, KEY_4, KEY_5, KEY_6, KEY_7, KEY_8, KEY_9, KEY_0, KEY_MINUS, KEY_EQUAL,
+  KEY_Q, KEY_W, KEY_E, KEY_R, KEY_T, KEY_Y, KEY_U, KEY_I, KEY_O, KEY_P, KEY_LEFTBRACE, KEY_RIGHTBRACE,
+  KEY_A, KEY_S, KEY_D, KEY_F, KEY_G, KEY_H, KEY_J, KEY_K, KEY_L, KEY_SEMICOLON, KEY_APOSTROPHE, KEY_BACKSLASH,
+  KEY_102ND, KEY_Z, KEY_X, KEY_C, KEY_V, KEY_B, KEY_N, KEY_M, KEY_COMMA, KEY_DOT, KEY_SLASH};
+
+struct keyboard_layout
+{
+  const char* name;
+  const char* plain;
+  const char* shift;
+  const char* altgr;
+  const text_key_extra* extras;
+  size_t total_extras;
+};
+
+constexpr text_key_extra uk_extras[] = {
+  {0xa3, {KEY_3, TEXT_MOD_SHIFT}}, // £
+  {0xac, {KEY_GRAVE, TEXT_MOD_SHIFT}}, // ¬
+  {0x20ac, {KEY_4, TEXT_MOD_ALTGR}}, // €
+};
+
+constexpr text_key_extra de_extras[] = {
+  {0xa7, {KEY_3, TEXT_MOD_SHIFT}}, // §
+  {0xb0, {KEY_GRAVE, TEXT_MOD_SHIFT}}, // °
+  {0xc4, {KEY_APOSTROPHE, TEXT_MOD_SHIFT}}, // Ä
+  {0xd6, {KEY_SEMICOLON, TEXT_MOD_SHIFT}}, // Ö
+  {0xdc, {KEY_LEFTBRACE, TEXT_MOD_SHIFT}}, // Ü
+  {0xdf, {KEY_MINUS, 0}}, // ß
+  {0xe4, {KEY_APOSTROPHE, 0}}, // ä
+  {0xf6, {KEY_SEMICOLON, 0}}, // ö
+  {0xfc, {KEY_LEFTBRACE, 0}}, // ü
+  {0x20ac, {KEY_E, TEXT_MOD_ALTGR}}, // €
+};
+
+constexpr text_key_extra fr_extras[] = {
+  {0xa3, {KEY_RIGHTBRACE, TEXT_MOD_SHIFT}}, // £
+  {0xa7, {KEY_SLASH, TEXT_MOD_SHIFT}}, // §
+  {0xb0, {KEY_MINUS, TEXT_MOD_SHIFT}}, // °
+  {0xb2, {KEY_GRAVE, 0}}, // ²
+  {0xb5, {KEY_BACKSLASH, TEXT_MOD_SHIFT}}, // µ
+  {0xe0, {KEY_0, 0}}, // à
+  {0xe7, {KEY_9, 0}}, // ç
+  {0xe8, {KEY_7, 0}}, // è
+  {0xe9, {KEY_2, 0}}, // é
+  {0xf9, {KEY_APOSTROPHE, 0}}, // ù
+  {0x20ac, {KEY_E, TEXT_MOD_ALTGR}}, // €
+};
+
+constexpr keyboard_layout keyboard_layouts[] = {
+  {"de",
+    " 1234567890  qwertzuiop +asdfghjkl  #<yxcvbnm,.-",
+    " !\" $%&/()=? QWERTZUIOP *ASDFGHJKL  '>YXCVBNM;:_",
+    "       {[]}\\ @          ~            |          ",
+    de_extras, TABLE_SIZE(de_extras)},
+  {"fr",
+    " & \"'(- _  )=azertyuiop $qsdfghjklm *<wxcvbn,;:!",
+    " 1234567890 +AZERTYUIOP  QSDFGHJKLM% >WXCVBN?./ ",
+    "   #{[| \\^@]}                                   ",
+    fr_extras, TABLE_SIZE(fr_extras)},
+  {"uk",
+    "`1234567890-=qwertyuiop[]asdfghjkl;'#\\zxcvbnm,./",
+    " !\" $%^&*()_+QWERTYUIOP{}ASDFGHJKL:@~|ZXCVBNM<>?",
+    "                                                ",
+    uk_extras, TABLE_SIZE(uk_extras)},
+  {"us",
+    "`1234567890-=qwertyuiop[]asdfghjkl;'\\ zxcvbnm,./",
+    "~!@#$%^&*()_+QWERTYUIOP{}ASDFGHJKL:\"| ZXCVBNM<>?",
+    "                                                ",
+    NULL, 0},
+};
 
-  write(uinp_fd, &ev, sizeof(ev));
+constexpr size_t textLength(const char* text)
+{
+  return (*text == '\0') ? 0 : 1 + textLength(text + 1);
 }
 
-void emitKey(int code, bool is_pressed, int modifier = 0)
+constexpr bool layoutsValid(const keyboard_layout* layouts, size_t total)
 {
-  if (!(modifier == 0) && is_pressed) {
-    emit(EV_KEY, modifier, is_pressed ? 1 : 0);
-    emit(EV_SYN, SYN_REPORT, 0);
-  }
-  emit(EV_KEY, code, is_pressed ? 1 : 0);
-  emit(EV_SYN, SYN_REPORT, 0);
-  if (!(modifier == 0) && !(is_pressed)) {
-    emit(EV_KEY, modifier, is_pressed ? 1 : 0);
-    emit(EV_SYN, SYN_REPORT, 0);
-  }
+  return (total == 0) || ((textLength(layouts->plain) == LAYOUT_KEYS) && (textLength(layouts->shift) == LAYOUT_KEYS) &&
+    (textLength(layouts->altgr) == LAYOUT_KEYS) && layoutsValid(layouts + 1, total - 1));
 }
+static_assert(layoutsValid(keyboard_layouts, TABLE_SIZE(keyboard_layouts)), "every keyboard layout level must list LAYOUT_KEYS characters");
+static_assert(namesSorted(keyboard_layouts, 0, TABLE_SIZE(keyboard_layouts)), "keyboard_layouts must be sorted by name");
 
-void emitTextInputKey(int code, bool uppercase)
+text_key text_keys[128];
+text_key character_set[maxKeysWithSymbols]; // keys of text_input_characters in the text input layout, code 0 for the ones it can't type
+const keyboard_layout* text_layout = NULL;
+short unicode_entry_keys[4]; // pressed together to start typing a code point in hex, e.g. ctrl+shift+u (TEXTINPUTUNICODE)
+int total_unicode_entry_keys = 0;
+
+void addLayoutLevel(const char* level, Uint8 modifiers)
 {
-  if (uppercase) { //capitalise capital letters by holding shift
-    emitKey(KEY_LEFTSHIFT, true);
-  }
-  emitKey(code, true);
-  SDL_Delay(16);
-  emitKey(code, false);
-  SDL_Delay(16);
-  if (uppercase) { //release shift if held
-    emitKey(KEY_LEFTSHIFT, false);
+  for (int ii = 0; ii < LAYOUT_KEYS; ii++) {
+    unsigned char ch = level[ii];
+    if ((ch != ' ') && (ch < 128) && (text_keys[ch].code == 0)) { // the first level that has a character wins
+      text_keys[ch] = {layout_key_codes[ii], modifiers};
+    }
   }
 }
 
-void addTextInputCharacter()
+// fill text_keys from a layout, false if there is no layout by that name
+bool selectTextLayout(const char* name)
 {
-  emitTextInputKey(character_set[current_key[current_character]],character_set_shift[current_key[current_character]]);
+  const keyboard_layout* layout = findByName(keyboard_layouts, name);
+  if (layout == NULL) {
+    return false;
+  }
+  text_layout = layout;
+  memset(text_keys, 0, sizeof(text_keys));
+  text_keys[(unsigned char)' '] = {KEY_SPACE, 0};
+  text_keys[(unsigned char)'\t'] = {KEY_TAB, 0};
+  text_keys[(unsigned char)'\n'] = {KEY_ENTER, 0};
+  addLayoutLevel(layout->plain, 0);
+  addLayoutLevel(layout->shift, TEXT_MOD_SHIFT);
+  addLayoutLevel(layout->altgr, TEXT_MOD_ALTGR);
+  return true;
 }
 
-void removeTextInputCharacter()
+// "leftctrl+leftshift+u": keys that start Unicode entry, characters the layout can't type are entered as their code point
+void setUnicodeEntryKeys(const char* names)
 {
-  emitTextInputKey(KEY_BACKSPACE,false); //delete one character
+  total_unicode_entry_keys = 0;
+  char name[32];
+  while ((*names != '\0') && (total_unicode_entry_keys < (int)TABLE_SIZE(unicode_entry_keys))) {
+    size_t length = strcspn(names, "+");
+    snprintf(name, sizeof(name), "%.*s", (int)length, names);
+    if (short code = char_to_keycode(name)) {
+      unicode_entry_keys[total_unicode_entry_keys++] = code;
+    }
+    names += length;
+    names += (*names == '+') ? 1 : 0;
+  }
 }
 
-void confirmTextInputCharacter()
+// decode one UTF-8 character and move past it, malformed bytes are returned one at a time as U+FFFD
+Uint32 nextCodepoint(const char*& text)
 {
-  emitTextInputKey(KEY_ENTER,false); //emit ENTER to confirm text input
+  const unsigned char* bytes = (const unsigned char*)text;
+  int length = (bytes[0] < 0x80) ? 1 : ((bytes[0] & 0xe0) == 0xc0) ? 2 : ((bytes[0] & 0xf0) == 0xe0) ? 3 : ((bytes[0] & 0xf8) == 0xf0) ? 4 : 0;
+  Uint32 codepoint = (length == 1) ? bytes[0] : (length == 2) ? (bytes[0] & 0x1f) : (length == 3) ? (bytes[0] & 0x0f) : (bytes[0] & 0x07);
+  for (int ii = 1; ii < length; ii++) {
+    if ((bytes[ii] & 0xc0) != 0x80) {
+      length = 0;
+      break;
+    }
+    codepoint = (codepoint << 6) | (bytes[ii] & 0x3f);
+  }
+  if (length == 0) {
+    text++;
+    return 0xfffd;
+  }
+  text += length;
+  return codepoint;
 }
 
-void nextTextInputKey(bool SingleIncrease) // enable fast skipping if SingleIncrease = false
+// key of a character in the selected layout, code 0 if it can only be entered as a code point
+text_key textKey(Uint32 codepoint)
 {
-  removeTextInputCharacter(); //delete character(s)
-  if (SingleIncrease) {
-    current_key[current_character]++;
-  } else {
-    current_key[current_character] = current_key[current_character] + 13; // jump forward by half alphabet
+  if (codepoint < 128) {
+    return text_keys[codepoint];
   }
-  if (current_key[current_character] >= maxKeys) {
-     current_key[current_character] = current_key[current_character] - maxKeys;
-  } else if ((current_character == 0) && (character_set[current_key[current_character]] == KEY_SPACE)) {
-      current_key[current_character]++; //skip space as first character 
+  for (size_t ii = 0; ii < text_layout->total_extras; ii++) {
+    if (text_layout->extras[ii].codepoint == codepoint) {
+      return text_layout->extras[ii].key;
+    }
   }
-
-  addTextInputCharacter(); //add new character
+  return {0, 0};
 }
 
-void prevTextInputKey(bool SingleDecrease)
+void initialiseCharacters()
 {
-  removeTextInputCharacter(); //delete character(s)
-  if (SingleDecrease) {
-    current_key[current_character]--;
+  if (textinputinteractive_noautocapitals) {
+    current_key[0] = 26; // if environment variable has been set to disable capitalisation of first characters start with all lower case  
   } else {
-    current_key[current_character] = current_key[current_character] - 13; // jump back by half alphabet  
+    current_key[0] = 0; // otherwise start with upper case for 1st character
   }
-  if (current_key[current_character] < 0) {
-     current_key[current_character] = current_key[current_character] + maxKeys;
-  } else if ((current_character == 0) && (character_set[current_key[current_character]] == KEY_SPACE)) {
-      current_key[current_character]--; //skip space as first character due to weird graphical issue with Exult
+  for (int ii = 1; ii < maxChars; ii++) { // start with lower case for other character onwards
+    current_key[ii] = 26;
   }
-  addTextInputCharacter(); //add new character
-}
 
-Uint32 repeatInputCallback(Uint32 interval, void *param)
-{
-    int key_code = *reinterpret_cast<int*>(param); 
-    if (key_code == KEY_UP) {
-      prevTextInputKey(true);
-      interval = config.key_repeat_interval; // key repeats according to repeat interval
-    } else if (key_code == KEY_DOWN) {
-      nextTextInputKey(true);
-      interval = config.key_repeat_interval; // key repeats according to repeat interval
-    } else {
-      interval = 0; //turn off timer if invalid keycode
-    }
-    return(interval);
 }
-void setInputRepeat(int code, bool is_pressed)
+
+void initialiseCharacterSet()
 {
-  if (is_pressed) {
-    state.key_to_repeat = code;
-    state.key_repeat_timer_id=SDL_AddTimer(config.key_repeat_interval, repeatInputCallback, &state.key_to_repeat); // for a new repeat, use repeat delay for first time, then switch to repeat interval
-  } else {
-    SDL_RemoveTimer( state.key_repeat_timer_id );
-    state.key_repeat_timer_id=0;
-    state.key_to_repeat=0;
+  if (textinputinteractive_extrasymbols) {
+    maxKeys = maxKeysWithSymbols;
+  }
+  for (int ii = 0; ii < maxKeysWithSymbols; ii++) { // typed with the keys of the text input layout, scrolling skips the ones it lacks
+    character_set[ii] = text_keys[(unsigned char)text_input_characters[ii]];
   }
+  initialiseCharacters();
 }
 
+// stick deflection (0..32768, in steps of 32) after the response curve, built when the config is
+// loaded so that a mouse tick only needs a lookup and a multiply per axis
+#define MOUSE_CURVE_SHIFT 5
+Sint32 mouse_curve[(32768 >> MOUSE_CURVE_SHIFT) + 1];
+Sint64 mouse_step_x = 0; // pixels per unit of curved deflection, 32.32 fixed point
+Sint64 mouse_step_y = 0;
+Sint64 scroll_step = 0; // high-resolution wheel units per unit of curved deflection
 
-void processKeys()
+void buildMouseCurve()
 {
-  int lenText = strlen(config.text_input_preset);
-  char str[2];
-  char lowerstr[2];
-  char upperstr[2];
-  char lowerchar;
-  char upperchar;
-  bool uppercase = false;
-  for (int ii = 0; ii < lenText; ii++) {  
-    if (config.text_input_preset[ii] != '\0') {
-        memcpy( str, &config.text_input_preset[ii], 1 );        
-        str[1] = '\0';
-
-        lowerchar = std::tolower(config.text_input_preset[ii], std::locale());
-        upperchar = std::toupper(config.text_input_preset[ii], std::locale());
-
-        memcpy( upperstr, &upperchar, 1 );        
-        upperstr[1] = '\0';
-        memcpy( lowerstr, &lowerchar, 1 );        
-        lowerstr[1] = '\0';
-        uppercase = (strcmp(upperstr,str) == 0);
-
-        int code = char_to_keycode(lowerstr);
-
-        if (strcmp(str, " ") == 0) {
-            code = KEY_SPACE;
-            uppercase = false;
-        } else if (strcmp(str, "_") == 0) {
-            code = KEY_MINUS;
-            uppercase = true;
-        } else if (strcmp(str, "-") == 0) {
-            code = KEY_MINUS;
-            uppercase = true;
-        } else if (strcmp(str, ".") == 0) {
-            code = KEY_DOT;
-            uppercase = false;
-        } else if (strcmp(str, ",") == 0) {
-            code = KEY_COMMA;
-            uppercase = false;
+  const int entries = (32768 >> MOUSE_CURVE_SHIFT) + 1;
+  for (int ii = 0; ii < entries; ii++) {
+    double input = (double)ii / (entries - 1); // 0..1
+    double output = input;
+    if (config.fake_mouse_curve == MOUSE_CURVE_EXPONENTIAL) {
+      output = pow(input, config.fake_mouse_curve_exponent);
+    } else if (config.fake_mouse_curve == MOUSE_CURVE_CUSTOM) {
+      // straight lines between (0,0), the configured points in order, and (100,100)
+      double from_x = 0, from_y = 0, to_x = 1, to_y = 1;
+      for (int point = 0; point < config.fake_mouse_curve_points; point++) {
+        double x = config.fake_mouse_curve_input[point] / 100.0;
+        double y = config.fake_mouse_curve_output[point] / 100.0;
+        if (x <= input) {
+          from_x = x;
+          from_y = y;
+        } else {
+          to_x = x;
+          to_y = y;
+          break;
         }
-        
-        emitTextInputKey(code, uppercase);
-    } // if valid character
-  } //for
-}
+      }
+      output = (to_x > from_x) ? from_y + (to_y - from_y) * (input - from_x) / (to_x - from_x) : from_y;
+    }
+    mouse_curve[ii] = (Sint32)(output * 32768 + 0.5);
+  }
 
-Uint32 repeatKeyCallback(Uint32 interval, void *param)
-{
-    //timerCallback requires pointer parameter, but passing pointer to key_code for analog sticks doesn't work
-    int key_code = *reinterpret_cast<int*>(param); 
-    emitKey(key_code, false);
-    emitKey(key_code, true); 
-    interval = config.key_repeat_interval; // key repeats according to repeat interval; initial interval is set to delay
-    return(interval);
+  int scale_x = (config.fake_mouse_scale_x > 0) ? config.fake_mouse_scale_x : config.fake_mouse_scale;
+  int scale_y = (config.fake_mouse_scale_y > 0) ? config.fake_mouse_scale_y : config.fake_mouse_scale;
+  mouse_step_x = (1LL << 32) / std::max(scale_x, 1);
+  mouse_step_y = (1LL << 32) / std::max(scale_y, 1);
+  scroll_step = (1LL << 32) / std::max(config.fake_scroll_scale, 1);
 }
-void setKeyRepeat(int code, bool is_pressed)
+
+void parseMouseCurve(const char* value)
 {
-  if (is_pressed) {
-    state.key_to_repeat=code;
-    state.key_repeat_timer_id=SDL_AddTimer(config.key_repeat_delay, repeatKeyCallback, &state.key_to_repeat); // for a new repeat, use repeat delay for first time, then switch to repeat interval
+  if (strcmp(value, "exponential") == 0) {
+    config.fake_mouse_curve = MOUSE_CURVE_EXPONENTIAL;
+  } else if (strcmp(value, "custom") == 0) {
+    config.fake_mouse_curve = MOUSE_CURVE_CUSTOM;
   } else {
-    SDL_RemoveTimer( state.key_repeat_timer_id );
-    state.key_repeat_timer_id=0;
-    state.key_to_repeat=0;
+    config.fake_mouse_curve = MOUSE_CURVE_LINEAR;
   }
 }
-void emitAxisMotion(int code, int value)
+
+void parseMouseCurveExponent(const char* value)
 {
-  emit(EV_ABS, code, value);
-  emit(EV_SYN, SYN_REPORT, 0);
+  config.fake_mouse_curve_exponent = std::max((float)atof(value), 0.1f);
 }
 
-void emitMouseMotion(int x, int y)
+void parseMouseCurvePoint(const char* value)
 {
-  if (x != 0) {
-    emit(EV_REL, REL_X, x);
-  }
-  if (y != 0) {
-    emit(EV_REL, REL_Y, y);
+  int input, output;
+  if (sscanf(value, "%d:%d", &input, &output) != 2) {
+    printf("mouse_curve_point %s is not deflection:speed\n", value);
+  } else if (config.fake_mouse_curve_points >= MOUSE_CURVE_MAX_POINTS) {
+    printf("mouse curve has too many points\n");
+  } else if ((config.fake_mouse_curve_points > 0) &&
+             (input <= config.fake_mouse_curve_input[config.fake_mouse_curve_points - 1])) {
+    printf("mouse_curve_point %s must come after the previous point\n", value);
+  } else {
+    config.fake_mouse_curve_input[config.fake_mouse_curve_points] = std::min(std::max(input, 0), 100);
+    config.fake_mouse_curve_output[config.fake_mouse_curve_points] = std::min(std::max(output, 0), 100);
+    config.fake_mouse_curve_points++;
+    config.fake_mouse_curve = MOUSE_CURVE_CUSTOM;
   }
+}
 
-  if (x != 0 || y != 0) {
-    emit(EV_SYN, SYN_REPORT, 0);
+// "text_input_grid = ABCDEFG" adds a row, kept as written so that a cached config suits any TEXTINPUTLAYOUT to the interactive text input virtual keyboard, \s is a space
+void parseTextInputGrid(const char* value)
+{
+  if (config.text_input_grid_rows == TEXT_GRID_MAX_ROWS) {
+    printf("text_input_grid has more than %d rows\n", TEXT_GRID_MAX_ROWS);
+    return;
   }
+  char* row = config.text_input_grid[config.text_input_grid_rows++];
+  int columns = 0;
+  for (const char* ch = value; *ch != '\0'; ch++) {
+    char wanted = *ch;
+    if ((ch[0] == '\\') && (ch[1] == 's')) {
+      wanted = ' ';
+      ch++;
+    }
+    if (strchr(text_input_characters, wanted) == NULL) {
+      printf("text_input_grid can't select %c\n", wanted);
+    } else if (columns == TEXT_GRID_MAX_COLUMNS) {
+      printf("text_input_grid row %s has more than %d characters\n", value, TEXT_GRID_MAX_COLUMNS);
+      break;
+    } else {
+      row[columns++] = wanted;
+    }
+  }
+  row[columns] = '\0';
 }
 
-void handleAnalogTrigger(bool is_triggered, bool& was_triggered, int key, int modifier=0)
+// where each character is on the virtual keyboard, so a d-pad move is a couple of lookups
+int text_grid[TEXT_GRID_MAX_ROWS][TEXT_GRID_MAX_COLUMNS]; // character_set index of each cell, -1 for none
+int text_grid_columns = 0;
+Sint8 text_grid_row[maxKeysWithSymbols]; // -1 if the character is not on the grid
+Sint8 text_grid_column[maxKeysWithSymbols];
+
+void buildTextGrid()
 {
-  if (is_triggered && !was_triggered) {
-    emitKey(key, true, modifier);
-  } else if (!is_triggered && was_triggered) {
-    emitKey(key, false, modifier);
+  memset(text_grid, -1, sizeof(text_grid));
+  memset(text_grid_row, -1, sizeof(text_grid_row));
+  memset(text_grid_column, -1, sizeof(text_grid_column));
+  text_grid_columns = 0;
+  for (int row = 0; row < config.text_input_grid_rows; row++) {
+    int column = 0;
+    for (const char* ch = config.text_input_grid[row]; *ch != '\0'; ch++) {
+      if (text_keys[(unsigned char)*ch].code == 0) { // left out, the rest of the row moves left
+        printf("text_input_grid can't select %c, the %s keyboard layout has no key for it\n", *ch, text_layout->name);
+        continue;
+      }
+      int key = strchr(text_input_characters, *ch) - text_input_characters;
+      text_grid[row][column] = key;
+      if (text_grid_row[key] < 0) {
+        text_grid_row[key] = row;
+        text_grid_column[key] = column;
+      }
+      text_grid_columns = std::max(text_grid_columns, column + 1);
+      column++;
+    }
   }
+}
+
+enum config_key_type
+{
+  CONFIG_KEY_BINDING, // a key, "add_alt"/"add_ctrl"/"add_shift", "repeat"/"repeat_delay_<ms>"/"repeat_interval_<ms>" or "turbo"/"turbo_<n>hz"; up to 12 keys are sent in turn
+  CONFIG_KEY_NUMBER,
+  CONFIG_KEY_MILLISECONDS,
+  CONFIG_KEY_HANDLER // value parsed by its own function
+};
+
+// one config file key and the config fields it sets
+struct config_key
+{
+  const char* name;
+  config_key_type type;
+  binding* bound;
+  bool* as_mouse; // analog sticks, "mouse_movement_<direction>" and "scroll_wheel_<direction>"
+  bool* as_scroll;
+  int* number;
+  Uint32* milliseconds;
+  void (*handler)(const char* value);
+};
 
-  was_triggered = is_triggered;
+constexpr config_key bindingKey(const char* name, int input, binding_layer layer)
+{
+  return {name, CONFIG_KEY_BINDING, &config.bindings[input][layer], NULL, NULL, NULL, NULL, NULL};
 }
 
-void setupFakeKeyboardMouseDevice(uinput_user_dev& device, int fd)
+constexpr config_key stickKey(const char* name, int input, bool* as_mouse, bool* as_scroll)
 {
-  strncpy(device.name, "Fake Keyboard", UINPUT_MAX_NAME_SIZE);
-  device.id.vendor = 0x1234;  /* sample vendor */
-  device.id.product = 0x5678; /* sample product */
+  return {name, CONFIG_KEY_BINDING, &config.bindings[input][LAYER_BASE], as_mouse, as_scroll, NULL, NULL, NULL};
+}
 
-  for (int i = 0; i < 256; i++) {
-    ioctl(fd, UI_SET_KEYBIT, i);
-  }
+constexpr config_key numberKey(const char* name, int* number)
+{
+  return {name, CONFIG_KEY_NUMBER, NULL, NULL, NULL, number, NULL, NULL};
+}
 
-  // Keys or Buttons
-  ioctl(fd, UI_SET_EVBIT, EV_KEY);
-  ioctl(fd, UI_SET_EVBIT, EV_SYN);
+constexpr config_key millisecondsKey(const char* name, Uint32* milliseconds)
+{
+  return {name, CONFIG_KEY_MILLISECONDS, NULL, NULL, NULL, NULL, milliseconds, NULL};
+}
 
-  // Fake mouse
-  ioctl(fd, UI_SET_EVBIT, EV_REL);
-  ioctl(fd, UI_SET_RELBIT, REL_X);
-  ioctl(fd, UI_SET_RELBIT, REL_Y);
-  ioctl(fd, UI_SET_KEYBIT, BTN_LEFT);
-  ioctl(fd, UI_SET_KEYBIT, BTN_RIGHT);
+constexpr config_key handlerKey(const char* name, void (*handler)(const char* value))
+{
+  return {name, CONFIG_KEY_HANDLER, NULL, NULL, NULL, NULL, NULL, handler};
 }
 
-void setupFakeXbox360Device(uinput_user_dev& device, int fd)
+// sorted by name for binary search, checked at compile time
+constexpr config_key config_keys[] = {
+  bindingKey("a", SDL_CONTROLLER_BUTTON_A, LAYER_BASE),
+  bindingKey("a_hk", SDL_CONTROLLER_BUTTON_A, LAYER_HOTKEY),
+  bindingKey("b", SDL_CONTROLLER_BUTTON_B, LAYER_BASE),
+  bindingKey("b_hk", SDL_CONTROLLER_BUTTON_B, LAYER_HOTKEY),
+  bindingKey("back", SDL_CONTROLLER_BUTTON_BACK, LAYER_BASE),
+  bindingKey("back_hk", SDL_CONTROLLER_BUTTON_BACK, LAYER_HOTKEY),
+  numberKey("deadzone_triggers", &config.deadzone_triggers),
+  numberKey("deadzone_x", &config.deadzone_x),
+  numberKey("deadzone_y", &config.deadzone_y),
+  bindingKey("down", SDL_CONTROLLER_BUTTON_DPAD_DOWN, LAYER_BASE),
+  bindingKey("down_hk", SDL_CONTROLLER_BUTTON_DPAD_DOWN, LAYER_HOTKEY),
+  bindingKey("guide", SDL_CONTROLLER_BUTTON_GUIDE, LAYER_BASE),
+  bindingKey("guide_hk", SDL_CONTROLLER_BUTTON_GUIDE, LAYER_HOTKEY),
+  bindingKey("l1", SDL_CONTROLLER_BUTTON_LEFTSHOULDER, LAYER_BASE),
+  bindingKey("l1_hk", SDL_CONTROLLER_BUTTON_LEFTSHOULDER, LAYER_HOTKEY),
+  bindingKey("l2", INPUT_L2, LAYER_BASE),
+  bindingKey("l2_hk", INPUT_L2, LAYER_HOTKEY),
+  bindingKey("l3", SDL_CONTROLLER_BUTTON_LEFTSTICK, LAYER_BASE),
+  bindingKey("l3_hk", SDL_CONTROLLER_BUTTON_LEFTSTICK, LAYER_HOTKEY),
+  bindingKey("left", SDL_CONTROLLER_BUTTON_DPAD_LEFT, LAYER_BASE),
+  stickKey("left_analog_down", INPUT_LEFT_ANALOG_DOWN, &config.left_analog_as_mouse, &config.left_analog_as_scroll),
+  bindingKey("left_analog_down_hk", INPUT_LEFT_ANALOG_DOWN, LAYER_HOTKEY),
+  stickKey("left_analog_left", INPUT_LEFT_ANALOG_LEFT, &config.left_analog_as_mouse, &config.left_analog_as_scroll),
+  bindingKey("left_analog_left_hk", INPUT_LEFT_ANALOG_LEFT, LAYER_HOTKEY),
+  stickKey("left_analog_right", INPUT_LEFT_ANALOG_RIGHT, &config.left_analog_as_mouse, &config.left_analog_as_scroll),
+  bindingKey("left_analog_right_hk", INPUT_LEFT_ANALOG_RIGHT, LAYER_HOTKEY),
+  stickKey("left_analog_up", INPUT_LEFT_ANALOG_UP, &config.left_analog_as_mouse, &config.left_analog_as_scroll),
+  bindingKey("left_analog_up_hk", INPUT_LEFT_ANALOG_UP, LAYER_HOTKEY),
+  bindingKey("left_hk", SDL_CONTROLLER_BUTTON_DPAD_LEFT, LAYER_HOTKEY),
+  handlerKey("mouse_curve", parseMouseCurve),
+  handlerKey("mouse_curve_exponent", parseMouseCurveExponent),
+  handlerKey("mouse_curve_point", parseMouseCurvePoint),
+  numberKey("mouse_delay", &config.fake_mouse_delay),
+  numberKey("mouse_scale", &config.fake_mouse_scale),
+  numberKey("mouse_scale_x", &config.fake_mouse_scale_x),
+  numberKey("mouse_scale_y", &config.fake_mouse_scale_y),
+  bindingKey("r1", SDL_CONTROLLER_BUTTON_RIGHTSHOULDER, LAYER_BASE),
+  bindingKey("r1_hk", SDL_CONTROLLER_BUTTON_RIGHTSHOULDER, LAYER_HOTKEY),
+  bindingKey("r2", INPUT_R2, LAYER_BASE),
+  bindingKey("r2_hk", INPUT_R2, LAYER_HOTKEY),
+  bindingKey("r3", SDL_CONTROLLER_BUTTON_RIGHTSTICK, LAYER_BASE),
+  bindingKey("r3_hk", SDL_CONTROLLER_BUTTON_RIGHTSTICK, LAYER_HOTKEY),
+  millisecondsKey("repeat_delay", &config.key_repeat_delay),
+  millisecondsKey("repeat_interval", &config.key_repeat_interval),
+  bindingKey("right", SDL_CONTROLLER_BUTTON_DPAD_RIGHT, LAYER_BASE),
+  stickKey("right_analog_down", INPUT_RIGHT_ANALOG_DOWN, &config.right_analog_as_mouse, &config.right_analog_as_scroll),
+  bindingKey("right_analog_down_hk", INPUT_RIGHT_ANALOG_DOWN, LAYER_HOTKEY),
+  stickKey("right_analog_left", INPUT_RIGHT_ANALOG_LEFT, &config.right_analog_as_mouse, &config.right_analog_as_scroll),
+  bindingKey("right_analog_left_hk", INPUT_RIGHT_ANALOG_LEFT, LAYER_HOTKEY),
+  stickKey("right_analog_right", INPUT_RIGHT_ANALOG_RIGHT, &config.right_analog_as_mouse, &config.right_analog_as_scroll),
+  bindingKey("right_analog_right_hk", INPUT_RIGHT_ANALOG_RIGHT, LAYER_HOTKEY),
+  stickKey("right_analog_up", INPUT_RIGHT_ANALOG_UP, &config.right_analog_as_mouse, &config.right_analog_as_scroll),
+  bindingKey("right_analog_up_hk", INPUT_RIGHT_ANALOG_UP, LAYER_HOTKEY),
+  bindingKey("right_hk", SDL_CONTROLLER_BUTTON_DPAD_RIGHT, LAYER_HOTKEY),
+  numberKey("scroll_scale", &config.fake_scroll_scale),
+  bindingKey("start", SDL_CONTROLLER_BUTTON_START, LAYER_BASE),
+  bindingKey("start_hk", SDL_CONTROLLER_BUTTON_START, LAYER_HOTKEY),
+  millisecondsKey("text_input_delay", &config.text_input_delay),
+  handlerKey("text_input_grid", parseTextInputGrid),
+  millisecondsKey("text_input_refresh", &config.text_input_refresh),
+  bindingKey("up", SDL_CONTROLLER_BUTTON_DPAD_UP, LAYER_BASE),
+  bindingKey("up_hk", SDL_CONTROLLER_BUTTON_DPAD_UP, LAYER_HOTKEY),
+  bindingKey("x", SDL_CONTROLLER_BUTTON_X, LAYER_BASE),
+  bindingKey("x_hk", SDL_CONTROLLER_BUTTON_X, LAYER_HOTKEY),
+  bindingKey("y", SDL_CONTROLLER_BUTTON_Y, LAYER_BASE),
+  bindingKey("y_hk", SDL_CONTROLLER_BUTTON_Y, LAYER_HOTKEY),
+};
+static_assert(namesSorted(config_keys, 0, TABLE_SIZE(config_keys)), "config_keys must be sorted by name");
+
+short modifierKeycode(const char* value) // "add_alt", "add_ctrl" or "add_shift", 0 for anything else
 {
-  strncpy(device.name, "Microsoft X-Box 360 pad", UINPUT_MAX_NAME_SIZE);
-  device.id.vendor = 0x045e;  /* sample vendor */
-  device.id.product = 0x028e; /* sample product */
+  if (strcmp(value, "add_alt") == 0) {
+    return KEY_LEFTALT;
+  } else if (strcmp(value, "add_ctrl") == 0) {
+    return KEY_LEFTCTRL;
+  } else if (strcmp(value, "add_shift") == 0) {
+    return KEY_LEFTSHIFT;
+  }
+  return 0;
+}
 
-  if (
-    ioctl(fd, UI_SET_EVBIT, EV_KEY) || ioctl(fd, UI_SET_EVBIT, EV_SYN) ||
-    ioctl(fd, UI_SET_EVBIT, EV_ABS) ||
-    // X-Box 360 pad buttons
-    ioctl(fd, UI_SET_KEYBIT, BTN_A) || ioctl(fd, UI_SET_KEYBIT, BTN_B) ||
-    ioctl(fd, UI_SET_KEYBIT, BTN_X) || ioctl(fd, UI_SET_KEYBIT, BTN_Y) ||
-    ioctl(fd, UI_SET_KEYBIT, BTN_TL) || ioctl(fd, UI_SET_KEYBIT, BTN_TR) ||
-    ioctl(fd, UI_SET_KEYBIT, BTN_THUMBL) ||
-    ioctl(fd, UI_SET_KEYBIT, BTN_THUMBR) ||
-    ioctl(fd, UI_SET_KEYBIT, BTN_SELECT) ||
-    ioctl(fd, UI_SET_KEYBIT, BTN_START) || ioctl(fd, UI_SET_KEYBIT, BTN_MODE) ||
-    // absolute (sticks)
-    ioctl(fd, UI_SET_ABSBIT, ABS_X) ||
-    ioctl(fd, UI_SET_ABSBIT, ABS_Y) ||
-    ioctl(fd, UI_SET_ABSBIT, ABS_RX) ||
-    ioctl(fd, UI_SET_ABSBIT, ABS_RY) ||
-    ioctl(fd, UI_SET_ABSBIT, ABS_Z) ||
-    ioctl(fd, UI_SET_ABSBIT, ABS_RZ) ||
-    ioctl(fd, UI_SET_ABSBIT, ABS_HAT0X) ||
-    ioctl(fd, UI_SET_ABSBIT, ABS_HAT0Y)) {
-    printf("Failed to configure fake Xbox 360 controller\n");
-    exit(-1);
+// the <n> of values like repeat_delay_<n> and turbo_<n>hz, false if it isn't a number followed by suffix
+bool parseValueNumber(const char* digits, const char* suffix, int& number)
+{
+  if ((*digits < '0') || (*digits > '9')) {
+    return false;
   }
+  char* end;
+  errno = 0;
+  long parsed = strtol(digits, &end, 10);
+  if ((errno != 0) || (parsed > INT_MAX) || (strcmp(end, suffix) != 0)) {
+    return false;
+  }
+  number = parsed;
+  return true;
+}
 
-  UINPUT_SET_ABS_P(&device, ABS_X, -32768, 32767, 16, 128);
-  UINPUT_SET_ABS_P(&device, ABS_Y, -32768, 32767, 16, 128);
-  UINPUT_SET_ABS_P(&device, ABS_RX, -32768, 32767, 16, 128);
-  UINPUT_SET_ABS_P(&device, ABS_RY, -32768, 32767, 16, 128);
-  UINPUT_SET_ABS_P(&device, ABS_HAT0X, -1, 1, 0, 0);
-  UINPUT_SET_ABS_P(&device, ABS_HAT0Y, -1, 1, 0, 0);
-  UINPUT_SET_ABS_P(&device, ABS_Z, 0, 255, 0, 0);
-  UINPUT_SET_ABS_P(&device, ABS_RZ, 0, 255, 0, 0);
+void invalidConfigValue(const char* name, const char* value)
+{
+  printf("invalid value %s for %s\n", value, name);
+  config_errors++;
 }
 
-bool handleEvent(const SDL_Event& event)
+void applyConfigOption(const config_key& key, const char* value)
 {
-  switch (event.type) {
-    case SDL_CONTROLLERBUTTONDOWN:
-    case SDL_CONTROLLERBUTTONUP: {
-      const bool is_pressed = event.type == SDL_CONTROLLERBUTTONDOWN;
+  int number;
+  switch (key.type) {
+    case CONFIG_KEY_BINDING: {
+      binding& bound = *key.bound;
+      short modifier = modifierKeycode(value);
+      if ((key.as_mouse != NULL) && (strncmp(value, "mouse_movement_", 15) == 0)) {
+        *key.as_mouse = true;
+        *key.as_scroll = false;
+      } else if ((key.as_scroll != NULL) && (strncmp(value, "scroll_wheel_", 13) == 0)) {
+        *key.as_scroll = true;
+        *key.as_mouse = false;
+      } else if (strcmp(value, "repeat") == 0) {
+        bound.repeat = true;
+      } else if (strncmp(value, "repeat_delay_", 13) == 0) {
+        if (parseValueNumber(value + 13, "", number)) {
+          bound.repeat = true;
+          bound.repeat_delay = std::max(number, 1);
+        } else {
+          invalidConfigValue(key.name, value);
+        }
+      } else if (strncmp(value, "repeat_interval_", 16) == 0) {
+        if (parseValueNumber(value + 16, "", number)) {
+          bound.repeat = true;
+          bound.repeat_interval = std::max(number, 1);
+        } else {
+          invalidConfigValue(key.name, value);
+        }
+      } else if (strcmp(value, "turbo") == 0) {
+        bound.turbo_hz = TURBO_DEFAULT_HZ;
+      } else if (strncmp(value, "turbo_", 6) == 0) { // "turbo_20hz"
+        if (parseValueNumber(value + 6, "hz", number)) {
+          bound.turbo_hz = std::min(std::max(number, 1), TURBO_MAX_HZ);
+        } else {
+          invalidConfigValue(key.name, value);
+        }
+      } else if (modifier != 0) {
+        bound.modifiers[std::max(bound.total_keys - 1, 0)] = modifier; // applies to the key assigned last
+      } else if (bound.total_keys < BINDING_MAX_KEYS) {
+        bound.keys[bound.total_keys++] = char_to_keycode(value);
+      } else {
+        printf("%s has too many key assignments\n", key.name);
+      }
+    } break;
 
-        if (state.textinputinteractive_mode_active) {
-        switch (event.cbutton.button) {
-          case SDL_CONTROLLER_BUTTON_DPAD_LEFT: //move back one character
-            if (is_pressed) {
-              removeTextInputCharacter();
-              if (current_character > 0) {
-                current_character--;
-              } else if (current_character == 0) {
-                removeTextInputCharacter();
-                initialiseCharacters();
-                addTextInputCharacter();
-              }
-            }
-            break; // SDL_CONTROLLER_BUTTON_DPAD_LEFT
-            
-          case SDL_CONTROLLER_BUTTON_DPAD_RIGHT: //add one more character
-            if (is_pressed) {
-              if ((character_set[current_key[current_character]] == KEY_SPACE) && (!(textinputinteractive_noautocapitals))) {
-                current_key[++current_character] = 0; // use capitals after a space
-              } else {
-                current_character++;
-              }
-              if (current_character < maxChars) {
-                addTextInputCharacter();
-              } else { // reached limit of characters
-                confirmTextInputCharacter();
-                state.textinputinteractive_mode_active = false;
-                printf("text input interactive mode no longer active\n");
-              }
-            }
-            break; //SDL_CONTROLLER_BUTTON_DPAD_RIGHT
-            
-          case SDL_CONTROLLER_BUTTON_DPAD_UP: //select previous key
-            if (is_pressed) {
-                prevTextInputKey(true);  
-                setInputRepeat(KEY_UP, true);        
-            } else {
-                setInputRepeat(KEY_UP, false);
-            }
-            break; //SDL_CONTROLLER_BUTTON_DPAD_UP
-            
-          case SDL_CONTROLLER_BUTTON_DPAD_DOWN:  //select next key
-            if (is_pressed) {
-                nextTextInputKey(true);
-                setInputRepeat(KEY_DOWN, true);        
-            } else {
-                setInputRepeat(KEY_DOWN, false);
-            }
-            break; //SDL_CONTROLLER_BUTTON_DPAD_DOWN
-            
-          case SDL_CONTROLLER_BUTTON_LEFTSHOULDER: //jump back by 13 letters
-            if (is_pressed) {
-                prevTextInputKey(false); //jump back by 13 letters
-                setInputRepeat(KEY_UP, false); //disable key repeat  
-            } else {
-                setInputRepeat(KEY_UP, false);
-            }
-            break; //SDL_CONTROLLER_BUTTON_LEFTSHOULDER
-            
-          case SDL_CONTROLLER_BUTTON_RIGHTSHOULDER:  //jump forward by 13 letters
-            if (is_pressed) {
-                nextTextInputKey(false); //jump forward by 13 letters
-                setInputRepeat(KEY_DOWN, false); //disable key repeat        
-            } else {
-                setInputRepeat(KEY_DOWN, false);
-            }
-            break; //SDL_CONTROLLER_BUTTON_RIGHTSHOULDER
+    case CONFIG_KEY_NUMBER:
+      *key.number = atoi(value);
+      break;
 
-          case SDL_CONTROLLER_BUTTON_A: //A buttons sends ENTER KEY
-            if (is_pressed) {
-              confirmTextInputCharacter();
-              //disable interactive mode
-              state.textinputinteractive_mode_active = false;
-              printf("text input interactive mode no longer active\n");
-            }
-            break; //SDL_CONTROLLER_BUTTON_A
+    case CONFIG_KEY_MILLISECONDS:
+      *key.milliseconds = atoi(value);
+      break;
 
-          case SDL_CONTROLLER_BUTTON_LEFTSTICK: // hotkey override
-          case SDL_CONTROLLER_BUTTON_BACK: // aka select
-            if (is_pressed) { // cancel key input and disable interactive input mode
-              for( int ii = 0; ii <= current_character; ii++ ) {
-                removeTextInputCharacter(); // delete all characters
-                if ((character_set[current_key[current_character]] == KEY_SPACE) && app_exult_adjust) {
-                  removeTextInputCharacter(); //remove extra spaces            
-                }
-              }
-              initialiseCharacters(); //reset the character selections ready for new text to be added later
-              state.textinputinteractive_mode_active = false;
-              printf("text input interactive mode no longer active\n");
-            }
-            break; //SDL_CONTROLLER_BUTTON_BACK
-            
-          case SDL_CONTROLLER_BUTTON_START:
-            if (is_pressed) { 
-              confirmTextInputCharacter(); // send ENTER key to confirm text entry
-              //disable interactive mode
-              state.textinputinteractive_mode_active = false;
-              printf("text input interactive mode no longer active\n");
-            }
-            break; //SDL_CONTROLLER_BUTTON_START
-            
-          }   //switch (event.cbutton.button) for textinputinteractive_mode_active     
-      } else if (xbox360_mode) {
-        // Fake Xbox360 mode
-        switch (event.cbutton.button) {
-          case SDL_CONTROLLER_BUTTON_A:
-            emitKey(BTN_A, is_pressed);
-            break;
+    case CONFIG_KEY_HANDLER:
+      key.handler(value);
+      break;
+  }
+}
 
-          case SDL_CONTROLLER_BUTTON_B:
-            emitKey(BTN_B, is_pressed);
-            break;
+void readConfigFile(const char* config_file)
+{
+  const auto parsedConfig = parseConfigFile(config_file);
+  for (const auto& co : parsedConfig) {
+    if (const config_key* key = findByName(config_keys, co.key)) {
+      applyConfigOption(*key, co.value);
+    }
+  }
+  buildMouseCurve();
+  buildTextGrid();
+}
 
-          case SDL_CONTROLLER_BUTTON_X:
-            emitKey(BTN_X, is_pressed);
-            break;
+Uint64 monotonicNanos()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
 
-          case SDL_CONTROLLER_BUTTON_Y:
-            emitKey(BTN_Y, is_pressed);
-            break;
+// compiled config cache: the parsed config and its mouse curve are written to a flat image keyed by
+// the config path, mtime and content hash, later launches map it instead of parsing the text again
+#define CONFIG_CACHE_MAGIC "GPTKCFG1"
+#define CONFIG_CACHE_VERSION 10 // bump when a config field changes meaning without changing the layout
 
-          case SDL_CONTROLLER_BUTTON_LEFTSHOULDER:
-            emitKey(BTN_TL, is_pressed);
-            break;
+const config_settings config_defaults = config_settings();
 
-          case SDL_CONTROLLER_BUTTON_RIGHTSHOULDER:
-            emitKey(BTN_TR, is_pressed);
-            break;
+struct config_cache_image // written and mapped as is, so no pointers
+{
+  char magic[8];
+  Uint32 version;
+  Uint32 config_size;
+  Uint64 defaults_hash; // defaults of the build that wrote it, a changed default invalidates the image
+  char source_path[PATH_MAX];
+  Sint64 source_mtime_ns;
+  Sint64 source_size;
+  Uint64 source_hash;
+  Uint64 parse_ns; // time the text parser took, reported as the time saved
+  Uint32 errors; // reported again, so a cached config is rejected on reload like a parsed one
+  config_settings settings;
+  Sint32 mouse_curve[(32768 >> MOUSE_CURVE_SHIFT) + 1];
+  Sint64 mouse_step_x;
+  Sint64 mouse_step_y;
+  Sint64 scroll_step;
+};
 
-          case SDL_CONTROLLER_BUTTON_LEFTSTICK:
-            emitKey(BTN_THUMBL, is_pressed);
-            if (kill_mode && hotkey_override && (strcmp(hotkey_code, "l3") == 0)) {
-                state.hotkey_jsdevice = event.cdevice.which;
-                state.hotkey_pressed = is_pressed;
-            }
-            break;
+struct
+{
+  bool cached = false; // config came from the image
+  Uint64 load_ns = 0; // time to load the config, from the image or the text
+  Uint64 parse_ns = 0; // time the text parser takes for this config
+} config_load_stats;
 
-          case SDL_CONTROLLER_BUTTON_RIGHTSTICK:
-            emitKey(BTN_THUMBR, is_pressed);
-            break;
+Uint64 fnv1a(const void* data, size_t size)
+{
+  const Uint8* bytes = (const Uint8*)data;
+  Uint64 hash = 14695981039346656037ULL;
+  for (size_t ii = 0; ii < size; ii++) {
+    hash = (hash ^ bytes[ii]) * 1099511628211ULL;
+  }
+  return hash;
+}
 
-          case SDL_CONTROLLER_BUTTON_BACK: // aka select
-            emitKey(BTN_SELECT, is_pressed);
-            if (!emuelec_override) {
-            if ((kill_mode && !(hotkey_override)) || (kill_mode && hotkey_override && (strcmp(hotkey_code, "back") == 0))) {
-              state.hotkey_jsdevice = event.cdevice.which;
-              state.hotkey_pressed = is_pressed;
-           }
-       }
-            break;
+bool hashFile(const char* path, Uint64& hash)
+{
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  std::string content;
+  char buffer[4096];
+  ssize_t len;
+  while ((len = read(fd, buffer, sizeof(buffer))) > 0) {
+    content.append(buffer, len);
+  }
+  close(fd);
+  hash = fnv1a(content.data(), content.size());
+  return len == 0;
+}
 
-          case SDL_CONTROLLER_BUTTON_GUIDE:
+Sint64 mtimeNanos(const struct stat& st)
+{
+  return (Sint64)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+}
+
+// GPTOKEYB_CACHE_DIR, then $XDG_CACHE_HOME/gptokeyb, then ~/.cache/gptokeyb, empty disables the cache
+std::string configCachePath(const char* source_path)
+{
+  std::string dir;
+  if (const char* env_cache_dir = SDL_getenv("GPTOKEYB_CACHE_DIR")) {
+    dir = env_cache_dir;
+  } else if (const char* env_xdg_cache = SDL_getenv("XDG_CACHE_HOME")) {
+    dir = std::string(env_xdg_cache) + "/gptokeyb";
+  } else if (const char* env_home = SDL_getenv("HOME")) {
+    dir = std::string(env_home) + "/.cache/gptokeyb";
+  }
+  if (dir.empty()) {
+    return dir;
+  }
+  char name[32];
+  snprintf(name, sizeof(name), "/%016llx.bin", (unsigned long long)fnv1a(source_path, strlen(source_path)));
+  return dir + name;
+}
+
+bool loadConfigCache(const std::string& cache_path, const char* source_path, const struct stat& source, bool& refresh)
+{
+  int fd = open(cache_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat cache;
+  void* mapping = MAP_FAILED;
+  if ((fstat(fd, &cache) == 0) && (cache.st_size == (off_t)sizeof(config_cache_image))) {
+    mapping = mmap(NULL, sizeof(config_cache_image), PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+
+  const config_cache_image& image = *(const config_cache_image*)mapping;
+  bool valid = (memcmp(image.magic, CONFIG_CACHE_MAGIC, sizeof(image.magic)) == 0)
+    && (image.version == CONFIG_CACHE_VERSION)
+    && (image.config_size == sizeof(config))
+    && (image.defaults_hash == fnv1a(&config_defaults, sizeof(config_defaults)))
+    && (strncmp(image.source_path, source_path, sizeof(image.source_path)) == 0);
+
+  refresh = false;
+  if (valid && ((image.source_mtime_ns != mtimeNanos(source)) || (image.source_size != (Sint64)source.st_size))) {
+    // touched or copied over with the same content, the hash decides
+    Uint64 source_hash;
+    valid = hashFile(source_path, source_hash) && (source_hash == image.source_hash);
+    refresh = valid;
+  }
+
+  if (valid) {
+    memcpy(&config, &image.settings, sizeof(config));
+    memcpy(mouse_curve, image.mouse_curve, sizeof(mouse_curve));
+    buildTextGrid();
+    mouse_step_x = image.mouse_step_x;
+    mouse_step_y = image.mouse_step_y;
+    scroll_step = image.scroll_step;
+    config_load_stats.parse_ns = image.parse_ns;
+    config_errors = image.errors;
+  }
+  munmap(mapping, sizeof(config_cache_image));
+  return valid;
+}
+
+// the loaded config as an image, the source fields are filled in by the caller
+config_cache_image* snapshotConfigCache()
+{
+  config_cache_image* image = new config_cache_image(); // value initialised, so padding and unused path bytes are zero
+  memcpy(image->magic, CONFIG_CACHE_MAGIC, sizeof(image->magic));
+  image->version = CONFIG_CACHE_VERSION;
+  image->config_size = sizeof(config);
+  image->defaults_hash = fnv1a(&config_defaults, sizeof(config_defaults));
+  image->parse_ns = config_load_stats.parse_ns;
+  image->errors = config_errors;
+  memcpy(&image->settings, &config, sizeof(config));
+  memcpy(image->mouse_curve, mouse_curve, sizeof(mouse_curve));
+  image->mouse_step_x = mouse_step_x;
+  image->mouse_step_y = mouse_step_y;
+  image->scroll_step = scroll_step;
+  return image;
+}
+
+void storeConfigCache(const std::string& cache_path, const config_cache_image* image)
+{
+  // create the cache directory and its parents
+  for (size_t slash = cache_path.find('/', 1); slash != std::string::npos; slash = cache_path.find('/', slash + 1)) {
+    mkdir(cache_path.substr(0, slash).c_str(), 0755);
+  }
+
+  // written aside and renamed, so that another instance never maps half an image
+  std::string temp_path = cache_path + ".tmp" + std::to_string(getpid());
+  int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  bool written = (fd >= 0) && (write(fd, image, sizeof(config_cache_image)) == (ssize_t)sizeof(config_cache_image));
+  if (fd >= 0) {
+    close(fd);
+  }
+  if (!written || (rename(temp_path.c_str(), cache_path.c_str()) != 0)) {
+    printf("unable to write config cache %s\n", cache_path.c_str());
+    unlink(temp_path.c_str());
+  }
+}
+
+void writeConfigCache(const std::string& cache_path, const char* source_path, const struct stat& source, Uint64 source_hash)
+{
+  config_cache_image* image = snapshotConfigCache();
+  snprintf(image->source_path, sizeof(image->source_path), "%s", source_path);
+  image->source_mtime_ns = mtimeNanos(source);
+  image->source_size = source.st_size;
+  image->source_hash = source_hash;
+  storeConfigCache(cache_path, image);
+  delete image;
+}
+
+// readConfigFile() through the compiled config cache
+void loadConfig(const char* config_file)
+{
+  Uint64 start_ns = monotonicNanos();
+  char source_path[PATH_MAX];
+  struct stat source;
+  std::string cache_path;
+  if ((realpath(config_file, source_path) != NULL) && (stat(source_path, &source) == 0)) {
+    cache_path = configCachePath(source_path);
+  }
+
+  bool refresh = false;
+  config_load_stats.cached = !cache_path.empty() && loadConfigCache(cache_path, source_path, source, refresh);
+  if (config_load_stats.cached) {
+    config_load_stats.load_ns = monotonicNanos() - start_ns;
+    if (refresh) { // same content with a new mtime, store it so the hash is not needed next time
+      Uint64 source_hash = 0;
+      hashFile(source_path, source_hash);
+      writeConfigCache(cache_path, source_path, source, source_hash);
+    }
+    return;
+  }
+
+  // hashed before parsing, if the file changes meanwhile its mtime no longer matches the image
+  Uint64 source_hash = 0;
+  bool hashed = !cache_path.empty() && hashFile(source_path, source_hash);
+  Uint64 parse_start_ns = monotonicNanos();
+  readConfigFile(config_file);
+  config_load_stats.parse_ns = monotonicNanos() - parse_start_ns;
+  config_load_stats.load_ns = monotonicNanos() - start_ns;
+  if (hashed) {
+    writeConfigCache(cache_path, source_path, source, source_hash);
+  }
+}
+
+void printConfigLoadStats()
+{
+  if (config_load_stats.cached) {
+    printf("config loaded from cache in %llu us (parsing takes %llu us)\n",
+      (unsigned long long)config_load_stats.load_ns / 1000, (unsigned long long)config_load_stats.parse_ns / 1000);
+  } else {
+    printf("config parsed in %llu us\n", (unsigned long long)config_load_stats.load_ns / 1000);
+  }
+}
+
+int applyDeadzone(int value, int deadzone)
+{
+  if (std::abs(value) > deadzone) {
+    return value;
+  } else {
+    return 0;
+  }
+}
+
+Uint64 replay_clock_ns = 0; // trace time of the input being replayed
+
+// clock for mouse ticks and key repeats: a replayed trace runs them on its own clock, so the
+// emitted events do not depend on how fast the replay goes
+Uint64 timerNanos()
+{
+  if (trace_replay_file != NULL) {
+    return replay_clock_ns;
+  }
+  return monotonicNanos();
+}
+
+int latencyBucket(Uint32 us)
+{
+  if (us < LATENCY_SUB_BUCKETS) {
+    return us;
+  }
+  int msb = 31 - __builtin_clz(us);
+  int sub = (us >> (msb - 3)) & (LATENCY_SUB_BUCKETS - 1);
+  return (msb - 2) * LATENCY_SUB_BUCKETS + sub;
+}
+
+Uint32 latencyBucketValue(int bucket) // lowest latency that falls into the bucket
+{
+  if (bucket < LATENCY_SUB_BUCKETS) {
+    return bucket;
+  }
+  int msb = bucket / LATENCY_SUB_BUCKETS + 2;
+  return (Uint32)(LATENCY_SUB_BUCKETS + bucket % LATENCY_SUB_BUCKETS) << (msb - 3);
+}
+
+// start timing an input, it is recorded when the first report it causes is written
+void beginLatencySample(latency_class input_class, Uint64 start_ns)
+{
+  if (emit_batch.latency_pending) {
+    return; // several inputs handled before one flush are timed from the earliest
+  }
+  emit_batch.latency_pending = true;
+  emit_batch.latency_input_class = input_class;
+  emit_batch.latency_start_ns = start_ns;
+}
+
+void setLatencyClass(latency_class input_class)
+{
+  emit_batch.latency_input_class = input_class;
+}
+
+// when the input happened: kernel timestamp for evdev, SDL's millisecond timestamp otherwise
+Uint64 latencyStartNanos(const SDL_Event& event)
+{
+  if (evdev_input_time_ns != 0) {
+    return evdev_input_time_ns;
+  }
+  return sdl_ticks_origin_ns + event.common.timestamp * 1000000ULL;
+}
+
+void recordLatency()
+{
+  Uint64 now = monotonicNanos();
+  Uint64 elapsed_us = (now > emit_batch.latency_start_ns) ? (now - emit_batch.latency_start_ns) / 1000 : 0;
+  Uint32 us = (Uint32)std::min(elapsed_us, (Uint64)0xffffffffU);
+  latency_histogram& histogram = latency_histograms[emit_batch.latency_input_class];
+
+  histogram.buckets[latencyBucket(us)].fetch_add(1, std::memory_order_relaxed);
+  histogram.samples.fetch_add(1, std::memory_order_relaxed);
+  Uint32 max_us = histogram.max_us.load(std::memory_order_relaxed);
+  while ((us > max_us) && !histogram.max_us.compare_exchange_weak(max_us, us, std::memory_order_relaxed)) {
+    // retry, another thread raised the maximum
+  }
+  emit_batch.latency_pending = false;
+}
+
+Uint32 latencyPercentile(const latency_histogram& histogram, Uint32 samples, int percent)
+{
+  Uint64 wanted = ((Uint64)samples * percent + 99) / 100;
+  Uint64 seen = 0;
+  for (int ii = 0; ii < LATENCY_BUCKETS; ii++) {
+    seen += histogram.buckets[ii].load(std::memory_order_relaxed);
+    if (seen >= wanted) {
+      return latencyBucketValue(ii);
+    }
+  }
+  return histogram.max_us.load(std::memory_order_relaxed);
+}
+
+// async-signal-safe number formatting for the SIGUSR1 dump
+char* appendText(char* out, const char* text)
+{
+  while (*text != '\0') {
+    *out++ = *text++;
+  }
+  return out;
+}
+
+char* appendNumber(char* out, Uint64 value)
+{
+  char digits[20];
+  int total = 0;
+  do {
+    digits[total++] = '0' + value % 10;
+    value /= 10;
+  } while (value > 0);
+  while (total > 0) {
+    *out++ = digits[--total];
+  }
+  return out;
+}
+
+void dumpLatencyHistograms(int /*signal*/)
+{
+  int saved_errno = errno;
+  int fd = STDERR_FILENO;
+  if (latency_dump_file != NULL) {
+    fd = open(latency_dump_file, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+      errno = saved_errno;
+      return;
+    }
+  }
+
+  for (int ii = 0; ii < LATENCY_CLASSES; ii++) {
+    const latency_histogram& histogram = latency_histograms[ii];
+    Uint32 samples = histogram.samples.load(std::memory_order_relaxed);
+    char line[160];
+    char* out = appendText(line, "latency ");
+    out = appendText(out, latency_class_names[ii]);
+    out = appendText(out, ": n=");
+    out = appendNumber(out, samples);
+    if (samples > 0) {
+      out = appendText(out, " p50=");
+      out = appendNumber(out, latencyPercentile(histogram, samples, 50));
+      out = appendText(out, "us p99=");
+      out = appendNumber(out, latencyPercentile(histogram, samples, 99));
+      out = appendText(out, "us max=");
+      out = appendNumber(out, histogram.max_us.load(std::memory_order_relaxed));
+      out = appendText(out, "us");
+    }
+    *out++ = '\n';
+    write(fd, line, out - line);
+  }
+
+  if (loop_stats.start_ns != 0) {
+    Uint64 now = monotonicNanos();
+    unsigned long wakeups = loop_stats.wakeups.load(std::memory_order_relaxed);
+    Uint64 since = (loop_stats.last_dump_ns != 0) ? loop_stats.last_dump_ns : loop_stats.start_ns;
+    Uint64 elapsed_ms = std::max<Uint64>((now - since) / 1000000ULL, 1);
+    char line[160];
+    char* out = appendText(line, "event loop: wakeups=");
+    out = appendNumber(out, wakeups);
+    out = appendText(out, " timer=");
+    out = appendNumber(out, loop_stats.timer_wakeups.load(std::memory_order_relaxed));
+    out = appendText(out, " rate=");
+    out = appendNumber(out, (wakeups - loop_stats.last_dump_wakeups) * 1000ULL / elapsed_ms);
+    out = appendText(out, "/s since last dump\n");
+    write(fd, line, out - line);
+    loop_stats.last_dump_wakeups = wakeups;
+    loop_stats.last_dump_ns = now;
+  }
+
+  unsigned long text_input_steps = text_input_stats.steps.load(std::memory_order_relaxed);
+  if (text_input_steps > 0) {
+    char line[160];
+    char* out = appendText(line, "text input: steps=");
+    out = appendNumber(out, text_input_steps);
+    out = appendText(out, " shown=");
+    out = appendNumber(out, text_input_stats.shown.load(std::memory_order_relaxed));
+    out = appendText(out, " events saved=");
+    out = appendNumber(out, text_input_stats.events_saved.load(std::memory_order_relaxed));
+    *out++ = '\n';
+    write(fd, line, out - line);
+  }
+
+  unsigned long reloads = reload_stats.reloads.load(std::memory_order_relaxed);
+  unsigned long reload_failures = reload_stats.failures.load(std::memory_order_relaxed);
+  {
+    char line[160];
+    char* out = appendText(line, "emit: events=");
+    out = appendNumber(out, emit_stats.events.load(std::memory_order_relaxed));
+    out = appendText(out, " writes=");
+    out = appendNumber(out, emit_stats.writes.load(std::memory_order_relaxed));
+    out = appendText(out, " max depth=");
+    out = appendNumber(out, emit_stats.max_depth.load(std::memory_order_relaxed));
+    out = appendText(out, " overflows=");
+    out = appendNumber(out, emit_stats.overflows.load(std::memory_order_relaxed));
+    out = appendText(out, " dropped=");
+    out = appendNumber(out, emit_stats.dropped.load(std::memory_order_relaxed));
+    out = appendText(out, " coalesced=");
+    out = appendNumber(out, emit_stats.coalesced.load(std::memory_order_relaxed));
+    *out++ = '\n';
+    write(fd, line, out - line);
+  }
+
+  if ((reloads > 0) || (reload_failures > 0)) {
+    char line[160];
+    char* out = appendText(line, "config reloads: ok=");
+    out = appendNumber(out, reloads);
+    out = appendText(out, " failed=");
+    out = appendNumber(out, reload_failures);
+    out = appendText(out, " last=");
+    out = appendNumber(out, reload_stats.last_us.load(std::memory_order_relaxed));
+    out = appendText(out, "us\n");
+    write(fd, line, out - line);
+  }
+
+  if (fd != STDERR_FILENO) {
+    close(fd);
+  }
+  errno = saved_errno;
+}
+
+// the whole report in one write(); uinput takes whole events, so a short write is continued from the
+// first event it did not take
+void writeReport(const struct input_event* events, int count)
+{
+  size_t size = count * sizeof(struct input_event);
+  const char* data = (const char*)events;
+  while (size > 0) {
+    ssize_t written = write(emit_fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      emit_stats.dropped += size / sizeof(struct input_event);
+      return;
+    }
+    data += written;
+    size -= written;
+  }
+}
+
+void flushEmitBatch()
+{
+  if (emit_batch.count == 0) {
+    emit_batch.syncs_requested = 0;
+    emit_batch.latency_pending = false; // input did not produce any output
+    return;
+  }
+
+  // close the frame with a single SYN_REPORT, however many were requested
+  struct input_event& syn = emit_batch.events[emit_batch.count++];
+  syn.type = EV_SYN;
+  syn.code = SYN_REPORT;
+  syn.value = 0;
+  syn.time.tv_sec = 0;
+  syn.time.tv_usec = 0;
+
+  if (emit_capture != NULL) {
+    emit_capture->insert(emit_capture->end(), emit_batch.events, emit_batch.events + emit_batch.count);
+  } else {
+    writeReport(emit_batch.events, emit_batch.count);
+  }
+  if (emit_batch.latency_pending) {
+    recordLatency();
+  }
+
+  // without batching every event and every requested SYN_REPORT was its own write()
+  emit_stats.legacy_writes += (emit_batch.count - 1) + std::max(emit_batch.syncs_requested, 1);
+  emit_stats.writes++;
+  emit_stats.events += emit_batch.count - 1;
+  if ((unsigned long)emit_batch.count > emit_stats.max_depth.load(std::memory_order_relaxed)) {
+    emit_stats.max_depth.store(emit_batch.count, std::memory_order_relaxed); // single writer, no race on the maximum
+  }
+
+  emit_batch.count = 0;
+  emit_batch.syncs_requested = 0;
+}
+
+void emit(int type, int code, int val)
+{
+  if (type == EV_SYN && code == SYN_REPORT) {
+    emit_batch.syncs_requested++; // report boundary is written once by flushEmitBatch()
+    return;
+  }
+
+  const bool is_axis = (type == EV_ABS) && (code >= 0) && (code < ABS_CNT);
+  if (is_axis && (held->axes[code] == val)) {
+    emit_stats.coalesced++; // the device has it already, or gets it with the pending report
+    return;
+  }
+
+  // an event for a code already in this frame (e.g. key release after press, or key repeat)
+  // must land in a new report, otherwise the game may never see the first state; a stick or trigger
+  // only has to end up in the right place, so its new value replaces the pending one instead
+  for (int ii = 0; ii < emit_batch.count; ii++) {
+    if (emit_batch.events[ii].type == type && emit_batch.events[ii].code == code) {
+      if (is_axis && (code < ABS_HAT0X)) { // the d-pad hats are buttons, every press must be seen
+        if (val == emit_batch.axis_before[ii]) { // back where the device is, nothing to send
+          emit_batch.count--;
+          memmove(&emit_batch.events[ii], &emit_batch.events[ii + 1], (emit_batch.count - ii) * sizeof(emit_batch.events[0]));
+          memmove(&emit_batch.axis_before[ii], &emit_batch.axis_before[ii + 1], (emit_batch.count - ii) * sizeof(int));
+        } else {
+          emit_batch.events[ii].value = val;
+        }
+        held->axes[code] = val;
+        emit_stats.coalesced++;
+        return;
+      }
+      flushEmitBatch();
+      break;
+    }
+  }
+  if (emit_batch.count >= EMIT_BATCH_MAX_EVENTS - 1) { // leave room for SYN_REPORT
+    emit_stats.overflows++;
+    flushEmitBatch();
+  }
+
+  struct input_event& ev = emit_batch.events[emit_batch.count++];
+
+  ev.type = type;
+  ev.code = code;
+  ev.value = val;
+  /* timestamp values below are ignored */
+  ev.time.tv_sec = 0;
+  ev.time.tv_usec = 0;
+
+  if ((type == EV_KEY) && (code >= 0) && (code < KEY_CNT)) {
+    Uint64 bit = 1ULL << (code % 64);
+    held->keys[code / 64] = (val != 0) ? (held->keys[code / 64] | bit) : (held->keys[code / 64] & ~bit);
+  } else if (is_axis) {
+    emit_batch.axis_before[emit_batch.count - 1] = held->axes[code];
+    held->axes[code] = val;
+  }
+}
+
+void emitPause(Uint32 ms)
+{
+  flushEmitBatch(); // send what has been emitted so far before waiting
+  if (!skip_emit_pauses) {
+    SDL_Delay(ms);
+  }
+}
+
+void printEmitStats()
+{
+  unsigned long writes = emit_stats.writes;
+  unsigned long legacy_writes = emit_stats.legacy_writes;
+  printf("emitted %lu events in %lu writes (%lu syscalls saved)\n", (unsigned long)emit_stats.events, writes, legacy_writes - writes);
+  printf("emit queue: max depth %lu, %lu overflows, %lu events dropped, %lu axis updates coalesced\n",
+    (unsigned long)emit_stats.max_depth, (unsigned long)emit_stats.overflows, (unsigned long)emit_stats.dropped,
+    (unsigned long)emit_stats.coalesced);
+}
+
+void emitKey(int code, bool is_pressed, int modifier = 0)
+{
+  if (!(modifier == 0) && is_pressed) {
+    emit(EV_KEY, modifier, is_pressed ? 1 : 0);
+    emit(EV_SYN, SYN_REPORT, 0);
+  }
+  emit(EV_KEY, code, is_pressed ? 1 : 0);
+  emit(EV_SYN, SYN_REPORT, 0);
+  if (!(modifier == 0) && !(is_pressed)) {
+    emit(EV_KEY, modifier, is_pressed ? 1 : 0);
+    emit(EV_SYN, SYN_REPORT, 0);
+  }
+}
+
+// everything the current device holds is released in one report, returns how many keys and axes that was
+int releaseHeldKeys()
+{
+  int released = 0;
+  for (int word = 0; word < KEY_LEDGER_WORDS; word++) {
+    for (Uint64 bits = held->keys[word]; bits != 0; bits &= bits - 1) {
+      emit(EV_KEY, word * 64 + __builtin_ctzll(bits), 0);
+      released++;
+    }
+  }
+  for (int code = 0; code < ABS_CNT; code++) {
+    if (held->axes[code] != 0) {
+      emit(EV_ABS, code, 0); // sticks and d-pad of a fake pad back in the centre
+      released++;
+    }
+  }
+  emit(EV_SYN, SYN_REPORT, 0);
+  flushEmitBatch();
+  return released;
+}
+
+// typed text and button taps are queued with the pauses between their keys and sent from the event
+// loop timer, so a long preset or a text input step never holds back other input
+struct key_sequence_step
+{
+  int input; // >= 0 presses or releases that input's binding instead of sending code
+  short code;
+  bool is_pressed;
+  Uint32 delay_ms; // pause before the next step
+};
+
+struct
+{
+  std::vector<key_sequence_step> steps; // cleared, not shrunk, once sent
+  size_t next = 0;
+  Uint64 due_ns = 0; // next step, or end of the last step's pause; 0 when idle
+} key_sequence;
+
+void queueKeySequenceStep(int input, short code, bool is_pressed, Uint32 delay_ms)
+{
+  key_sequence.steps.push_back({input, code, is_pressed, delay_ms});
+  if (key_sequence.due_ns == 0) {
+    key_sequence.due_ns = timerNanos(); // starts with the next runDueTimers()
+  }
+}
+
+void emitTextInputKey(int code, bool uppercase)
+{
+  if (uppercase) { //capitalise capital letters by holding shift
+    queueKeySequenceStep(-1, KEY_LEFTSHIFT, true, 0);
+  }
+  queueKeySequenceStep(-1, code, true, config.text_input_delay);
+  queueKeySequenceStep(-1, code, false, config.text_input_delay);
+  if (uppercase) { //release shift if held
+    queueKeySequenceStep(-1, KEY_LEFTSHIFT, false, 0);
+  }
+}
+
+void setTextModifiers(Uint8& held, Uint8 wanted)
+{
+  if ((held & TEXT_MOD_SHIFT) != (wanted & TEXT_MOD_SHIFT)) {
+    queueKeySequenceStep(-1, KEY_LEFTSHIFT, (wanted & TEXT_MOD_SHIFT) != 0, 0);
+  }
+  if ((held & TEXT_MOD_ALTGR) != (wanted & TEXT_MOD_ALTGR)) {
+    queueKeySequenceStep(-1, KEY_RIGHTALT, (wanted & TEXT_MOD_ALTGR) != 0, 0);
+  }
+  held = wanted;
+}
+
+void typeTextKey(Uint8& held, text_key key)
+{
+  setTextModifiers(held, key.modifiers);
+  queueKeySequenceStep(-1, key.code, true, config.text_input_delay);
+  queueKeySequenceStep(-1, key.code, false, config.text_input_delay);
+}
+
+void addTextInputCharacter()
+{
+  Uint8 held = 0;
+  typeTextKey(held, character_set[current_key[current_character]]); // with shift or AltGr as the layout needs
+  setTextModifiers(held, 0);
+}
+
+void removeTextInputCharacter()
+{
+  emitTextInputKey(KEY_BACKSPACE,false); //delete one character
+}
+
+void confirmTextInputCharacter()
+{
+  emitTextInputKey(KEY_ENTER,false); //emit ENTER to confirm text input
+}
+
+// interactive text input scrolling: with text_input_refresh set the selection changes at once, but the game
+// is sent the selected character at most once per refresh period, so fast scrolling skips the ones in between
+void showTextInputSelection()
+{
+  removeTextInputCharacter(); //delete character(s)
+  addTextInputCharacter(); //add new character
+  state.text_input_pending = false;
+  state.text_input_refresh_ns = timerNanos() + config.text_input_refresh * 1000000ULL;
+  text_input_stats.shown++;
+}
+
+// a selection waiting for the refresh period to end; one on the virtual keyboard waits for commitTextInputSelection() instead
+bool textInputRefreshPending()
+{
+  return state.text_input_pending && (config.text_input_grid_rows == 0);
+}
+
+// send the selection now if it is waiting, before the cursor moves on or text is confirmed
+void commitTextInputSelection()
+{
+  if (state.text_input_pending) {
+    showTextInputSelection();
+  }
+}
+
+void textInputSelectionChanged(int previous_key)
+{
+  text_input_stats.steps++;
+  if (state.text_input_pending) {
+    // the selection that was waiting is replaced without ever being sent: backspace, key and maybe shift
+    const Uint8 modifiers = character_set[previous_key].modifiers;
+    text_input_stats.events_saved += 4 + ((modifiers & TEXT_MOD_SHIFT) ? 2 : 0) + ((modifiers & TEXT_MOD_ALTGR) ? 2 : 0);
+  }
+  if (config.text_input_grid_rows > 0) {
+    state.text_input_pending = true; // only the cell that is picked is typed, not every one passed on the way
+  } else if ((config.text_input_refresh == 0) || (!state.text_input_pending && (timerNanos() >= state.text_input_refresh_ns))) {
+    showTextInputSelection();
+  } else {
+    state.text_input_pending = true; // runDueTimers() sends it when the refresh period is over
+  }
+}
+
+void nextTextInputKey(bool SingleIncrease) // enable fast skipping if SingleIncrease = false
+{
+  int previous_key = current_key[current_character];
+  if (SingleIncrease) {
+    current_key[current_character]++;
+  } else {
+    current_key[current_character] = current_key[current_character] + 13; // jump forward by half alphabet
+  }
+  if (current_key[current_character] >= maxKeys) {
+     current_key[current_character] = current_key[current_character] - maxKeys;
+  } else if ((current_character == 0) && (character_set[current_key[current_character]].code == KEY_SPACE)) {
+      current_key[current_character]++; //skip space as first character 
+  }
+  while (character_set[current_key[current_character]].code == 0) { // the layout has no key for it, letters always have one
+    current_key[current_character] = (current_key[current_character] + 1) % maxKeys;
+  }
+  textInputSelectionChanged(previous_key);
+}
+
+void prevTextInputKey(bool SingleDecrease)
+{
+  int previous_key = current_key[current_character];
+  if (SingleDecrease) {
+    current_key[current_character]--;
+  } else {
+    current_key[current_character] = current_key[current_character] - 13; // jump back by half alphabet  
+  }
+  if (current_key[current_character] < 0) {
+     current_key[current_character] = current_key[current_character] + maxKeys;
+  } else if ((current_character == 0) && (character_set[current_key[current_character]].code == KEY_SPACE)) {
+      current_key[current_character]--; //skip space as first character due to weird graphical issue with Exult
+  }
+  while (character_set[current_key[current_character]].code == 0) { // the layout has no key for it, letters always have one
+    current_key[current_character] = (current_key[current_character] + maxKeys - 1) % maxKeys;
+  }
+  textInputSelectionChanged(previous_key);
+}
+
+bool selectTextGridCell(int row, int column, int previous_key)
+{
+  int key = text_grid[row][column];
+  if ((key < 0) || (key >= maxKeys)) { // empty, or an extra symbol while they are off
+    return false;
+  }
+  current_key[current_character] = key;
+  textInputSelectionChanged(previous_key);
+  return true;
+}
+
+// move the selection one cell on the virtual keyboard, wrapping around and skipping empty cells
+void moveTextGridSelection(short direction)
+{
+  int previous_key = current_key[current_character];
+  int rows = config.text_input_grid_rows;
+  int row = text_grid_row[previous_key];
+  int column = text_grid_column[previous_key];
+  if (row < 0) { // not on the grid (e.g. the capital a word starts with), go to the first cell
+    for (int cell = 0; cell < rows * text_grid_columns; cell++) {
+      if (selectTextGridCell(cell / text_grid_columns, cell % text_grid_columns, previous_key)) {
+        return;
+      }
+    }
+    return;
+  }
+  int row_step = (direction == KEY_UP) ? -1 : (direction == KEY_DOWN) ? 1 : 0;
+  int column_step = (direction == KEY_LEFT) ? -1 : (direction == KEY_RIGHT) ? 1 : 0;
+  for (int ii = 0; ii < std::max(rows, text_grid_columns); ii++) {
+    row = (row + row_step + rows) % rows;
+    column = (column + column_step + text_grid_columns) % text_grid_columns;
+    if (selectTextGridCell(row, column, previous_key)) {
+      return;
+    }
+  }
+}
+
+short textInputDirection(int button)
+{
+  switch (button) {
+    case SDL_CONTROLLER_BUTTON_DPAD_UP:
+      return KEY_UP;
+    case SDL_CONTROLLER_BUTTON_DPAD_DOWN:
+      return KEY_DOWN;
+    case SDL_CONTROLLER_BUTTON_DPAD_LEFT:
+      return KEY_LEFT;
+    case SDL_CONTROLLER_BUTTON_DPAD_RIGHT:
+      return KEY_RIGHT;
+  }
+  return 0;
+}
+
+// one step of d-pad scrolling, direction is KEY_UP/KEY_DOWN and with a grid also KEY_LEFT/KEY_RIGHT
+void stepTextInputSelection(short direction)
+{
+  if (config.text_input_grid_rows > 0) {
+    moveTextGridSelection(direction);
+  } else if (direction == KEY_UP) {
+    prevTextInputKey(true);
+  } else {
+    nextTextInputKey(true);
+  }
+}
+
+// next deadline of a periodic timer; a tick that is late does not shift the ones after it,
+// unless it is so late that a whole period was missed
+Uint64 nextPeriodNanos(Uint64 due_ns, Uint64 period_ns, Uint64 now_ns)
+{
+  Uint64 next_ns = due_ns + period_ns;
+  if (next_ns <= now_ns) {
+    next_ns = now_ns + period_ns;
+  }
+  return next_ns;
+}
+
+Uint64 nextPeriod(Uint64 due_ns, Uint32 period_ms, Uint64 now_ns)
+{
+  return nextPeriodNanos(due_ns, std::max(period_ms, (Uint32)1) * 1000000ULL, now_ns);
+}
+
+// ties are taken in slot order, so a replay repeats keys that are due together in the same order
+bool repeatBefore(const key_repeat& a, const key_repeat& b)
+{
+  return (a.due_ns != b.due_ns) ? (a.due_ns < b.due_ns) : (a.slot < b.slot);
+}
+
+void placeRepeat(int index, const key_repeat& entry)
+{
+  state.repeats[index] = entry;
+  state.repeat_position[entry.slot] = index + 1;
+}
+
+// move the entry at index up or down the heap until the heap is ordered again
+void siftRepeat(int index)
+{
+  key_repeat entry = state.repeats[index];
+  while (index > 0) {
+    int parent = (index - 1) / 2;
+    if (!repeatBefore(entry, state.repeats[parent])) {
+      break;
+    }
+    placeRepeat(index, state.repeats[parent]);
+    index = parent;
+  }
+  while (true) {
+    int child = index * 2 + 1;
+    if (child >= state.total_repeats) {
+      break;
+    }
+    if ((child + 1 < state.total_repeats) && repeatBefore(state.repeats[child + 1], state.repeats[child])) {
+      child++;
+    }
+    if (!repeatBefore(state.repeats[child], entry)) {
+      break;
+    }
+    placeRepeat(index, state.repeats[child]);
+    index = child;
+  }
+  placeRepeat(index, entry);
+}
+
+// first repeat after delay_ns, then one every interval_ns; restarts the slot's schedule if it was already repeating
+void startRepeat(int slot, short key, short modifier, Uint64 delay_ns, Uint64 interval_ns, bool turbo = false)
+{
+  int index = state.repeat_position[slot] - 1;
+  if (index < 0) {
+    index = state.total_repeats++;
+  }
+  state.repeats[index] = {timerNanos() + delay_ns, slot, key, modifier, std::max(interval_ns, (Uint64)1), turbo};
+  siftRepeat(index);
+}
+
+void stopRepeat(int slot)
+{
+  int index = state.repeat_position[slot] - 1;
+  if (index < 0) {
+    return;
+  }
+  state.repeat_position[slot] = 0;
+  state.total_repeats--;
+  if (index < state.total_repeats) {
+    state.repeats[index] = state.repeats[state.total_repeats]; // last entry fills the hole
+    siftRepeat(index);
+  }
+}
+
+void stopAllRepeats()
+{
+  state.total_repeats = 0;
+  memset(state.repeat_position, 0, sizeof(state.repeat_position));
+}
+
+void setInputRepeat(int code, bool is_pressed)
+{
+  if (is_pressed) {
+    Uint64 interval_ns = config.key_repeat_interval * 1000000ULL;
+    startRepeat(REPEAT_TEXT_INPUT, code, 0, interval_ns, interval_ns);
+  } else {
+    stopRepeat(REPEAT_TEXT_INPUT);
+  }
+}
+
+// a character the layout has no key for, entered as its code point in hex after the Unicode entry keys
+void typeCodepoint(Uint8& held, Uint32 codepoint)
+{
+  setTextModifiers(held, 0);
+  for (int ii = 0; ii < total_unicode_entry_keys; ii++) {
+    queueKeySequenceStep(-1, unicode_entry_keys[ii], true, (ii == total_unicode_entry_keys - 1) ? config.text_input_delay : 0);
+  }
+  for (int ii = total_unicode_entry_keys - 1; ii >= 0; ii--) {
+    queueKeySequenceStep(-1, unicode_entry_keys[ii], false, (ii == 0) ? config.text_input_delay : 0);
+  }
+  char hex[9];
+  snprintf(hex, sizeof(hex), "%x", codepoint);
+  for (const char* digit = hex; *digit != '\0'; digit++) {
+    typeTextKey(held, text_keys[(unsigned char)*digit]);
+  }
+  typeTextKey(held, text_keys[(unsigned char)' ']); // ends the entry
+}
+
+void processKeys()
+{
+  setLatencyClass(LATENCY_TEXT);
+  Uint8 held = 0;
+  for (const char* text = text_input_preset; *text != '\0';) {
+    Uint32 codepoint = nextCodepoint(text);
+    text_key key = textKey(codepoint);
+    if (key.code != 0) {
+      typeTextKey(held, key);
+    } else if (total_unicode_entry_keys > 0) {
+      typeCodepoint(held, codepoint);
+    } else {
+      printf("text input can't type U+%04X with the %s layout\n", codepoint, text_layout->name);
+    }
+  }
+  setTextModifiers(held, 0);
+}
+
+// send every key repeat that is due, each one moves down the heap to its next deadline
+void repeatTick(Uint64 now_ns)
+{
+  while ((state.total_repeats > 0) && (state.repeats[0].due_ns <= now_ns)) {
+    key_repeat& entry = state.repeats[0];
+    if (entry.slot == REPEAT_TEXT_INPUT) {
+      if ((config.text_input_refresh == 0) && (key_sequence.due_ns != 0)) {
+        // previous character is still being typed, skip this step rather than queue up steps
+      } else {
+        beginLatencySample(LATENCY_TEXT, monotonicNanos());
+        stepTextInputSelection(entry.key);
+      }
+    } else {
+      bool is_pressed = !entry.turbo || !keyHeld(entry.key);
+      if (entry.turbo) {
+        beginLatencySample(LATENCY_TURBO, (trace_replay_file == NULL) ? entry.due_ns : monotonicNanos());
+      } else {
+        beginLatencySample(LATENCY_REPEAT, monotonicNanos());
+      }
+      if (is_pressed && (entry.modifier != 0) && !keyHeld(entry.modifier)) {
+        emitKey(entry.modifier, true); // released meanwhile by another input with the same modifier
+      }
+      if (!entry.turbo) {
+        emitKey(entry.key, false);
+      }
+      emitKey(entry.key, is_pressed);
+    }
+    entry.due_ns = nextPeriodNanos(entry.due_ns, entry.interval_ns, now_ns);
+    siftRepeat(0);
+  }
+}
+void emitAxisMotion(int code, int value)
+{
+  emit(EV_ABS, code, value);
+  emit(EV_SYN, SYN_REPORT, 0);
+}
+
+void emitMouseMotion(int x, int y)
+{
+  if (x != 0) {
+    emit(EV_REL, REL_X, x);
+  }
+  if (y != 0) {
+    emit(EV_REL, REL_Y, y);
+  }
+
+  if (x != 0 || y != 0) {
+    emit(EV_SYN, SYN_REPORT, 0);
+  }
+}
+
+// scroll by high-resolution units, with a classic wheel click for every SCROLL_UNITS_PER_NOTCH
+void emitScrollMotion(int x, int y)
+{
+  if (y != 0) {
+    emit(EV_REL, REL_WHEEL_HI_RES, -y); // stick up scrolls up
+    state.scroll_notch_y -= y;
+    if (std::abs(state.scroll_notch_y) >= SCROLL_UNITS_PER_NOTCH) {
+      emit(EV_REL, REL_WHEEL, state.scroll_notch_y / SCROLL_UNITS_PER_NOTCH);
+      state.scroll_notch_y %= SCROLL_UNITS_PER_NOTCH;
+    }
+  }
+  if (x != 0) {
+    emit(EV_REL, REL_HWHEEL_HI_RES, x);
+    state.scroll_notch_x += x;
+    if (std::abs(state.scroll_notch_x) >= SCROLL_UNITS_PER_NOTCH) {
+      emit(EV_REL, REL_HWHEEL, state.scroll_notch_x / SCROLL_UNITS_PER_NOTCH);
+      state.scroll_notch_x %= SCROLL_UNITS_PER_NOTCH;
+    }
+  }
+
+  if (x != 0 || y != 0) {
+    emit(EV_SYN, SYN_REPORT, 0);
+  }
+}
+
+// whole pixels (or scroll units) to move along one axis this tick, the fraction is kept for the next one
+int mouseAxisPixels(int deflection, Sint64 step, Sint64& remainder)
+{
+  if (deflection == 0) {
+    remainder = 0; // stick centred, don't let an old fraction nudge the next movement
+    return 0;
+  }
+  Sint64 movement = mouse_curve[std::abs(deflection) >> MOUSE_CURVE_SHIFT] * step;
+  remainder += (deflection < 0) ? -movement : movement;
+  int pixels = (int)(remainder / (1LL << 32)); // towards zero, so both directions move alike
+  remainder -= (Sint64)pixels << 32;
+  return pixels;
+}
+
+void mouseTick(Uint64 now_ns)
+{
+  beginLatencySample(LATENCY_MOUSE, (trace_replay_file == NULL) ? state.mouse_tick_ns : monotonicNanos());
+  emitMouseMotion(
+    mouseAxisPixels(state.mouseX, mouse_step_x, state.mouse_remainder_x),
+    mouseAxisPixels(state.mouseY, mouse_step_y, state.mouse_remainder_y));
+  emitScrollMotion( // same report as the pointer movement
+    mouseAxisPixels(state.scrollX, scroll_step, state.scroll_remainder_x),
+    mouseAxisPixels(state.scrollY, scroll_step, state.scroll_remainder_y));
+  state.mouse_tick_ns = nextPeriod(state.mouse_tick_ns, config.fake_mouse_delay, now_ns);
+}
+
+bool bindingAssigned(const binding& bound)
+{
+  return (bound.total_keys > 0) || (bound.keys[0] != 0);
+}
+
+// press or release the key an input is bound to; while the hotkey is held the hotkey layer is used if it is assigned
+void handleBinding(int input, bool is_pressed)
+{
+  binding_state& input_state = state.bindings[input];
+  if (is_pressed == input_state.pressed) {
+    return;
+  }
+
+  if (is_pressed) {
+    int layer = LAYER_BASE;
+    if (state.hotkey_pressed && bindingAssigned(config.bindings[input][LAYER_HOTKEY])) {
+      layer = LAYER_HOTKEY;
+      state.hotkey_combo_triggered = true; // releasing the hotkey must not send its own key
+    }
+    const binding& bound = config.bindings[input][layer];
+    int index = input_state.cycle[layer];
+    input_state.pressed = true;
+    input_state.layer = layer;
+    input_state.key = bound.keys[index];
+    input_state.modifier = bound.modifiers[index];
+    if (input_state.key != 0) { // unassigned with `button = \"`
+      emitKey(input_state.key, true, input_state.modifier);
+      if (bound.turbo_hz != 0) {
+        Uint64 half_period_ns = 500000000ULL / bound.turbo_hz; // released after half a period, pressed again after the other half
+        startRepeat(input, input_state.key, input_state.modifier, half_period_ns, half_period_ns, true);
+      } else if (bound.repeat) {
+        startRepeat(input, input_state.key, input_state.modifier,
+          ((bound.repeat_delay != 0) ? bound.repeat_delay : config.key_repeat_delay) * 1000000ULL,
+          ((bound.repeat_interval != 0) ? bound.repeat_interval : config.key_repeat_interval) * 1000000ULL);
+      }
+    }
+    return;
+  }
+
+  input_state.pressed = false;
+  if ((input_state.key != 0) && keyHeld(input_state.key)) {
+    emitKey(input_state.key, false, input_state.modifier);
+  } else if (input_state.modifier != 0) {
+    emitKey(input_state.modifier, false); // turbo key is already up
+  }
+  const binding& bound = config.bindings[input][input_state.layer];
+  stopRepeat(input);
+  if ((input_state.key != 0) && bound.repeat) {
+    // a repeating key stays on the same key of the set
+  } else if ((input_state.layer == LAYER_HOTKEY) && state.hotkey_pressed) {
+    // the same key of the set is sent again until the hotkey is released
+  } else if (bound.total_keys > 1) {
+    input_state.cycle[input_state.layer] = (input_state.cycle[input_state.layer] + 1) % bound.total_keys;
+  }
+}
+
+// the hotkey and start buttons take part in combos, so their own key is only sent when they are released without one
+void handleComboButton(int input, bool is_pressed, bool is_held, bool& was_pressed, bool& combo_triggered)
+{
+  if (is_held) {
+    was_pressed = true;
+  } else if (combo_triggered && !is_pressed) {
+    combo_triggered = false; // combo was used, ignore the release
+    was_pressed = false;
+  } else if (was_pressed && !is_pressed) {
+    was_pressed = false;
+    queueKeySequenceStep(input, 0, true, config.text_input_delay); // a tap, after any text already queued
+    queueKeySequenceStep(input, 0, false, 0);
+  } else {
+    handleBinding(input, is_pressed);
+  }
+}
+
+// send the queued steps that are due, up to the next pause
+void runKeySequence(Uint64 now_ns)
+{
+  while ((key_sequence.due_ns != 0) && (key_sequence.due_ns <= now_ns)) {
+    if (key_sequence.next == key_sequence.steps.size()) {
+      key_sequence.steps.clear(); // the last step's pause is over
+      key_sequence.next = 0;
+      key_sequence.due_ns = 0;
+      break;
+    }
+    const key_sequence_step step = key_sequence.steps[key_sequence.next++];
+    if (step.input >= 0) {
+      handleBinding(step.input, step.is_pressed);
+    } else {
+      emitKey(step.code, step.is_pressed);
+    }
+    if (step.delay_ms > 0) {
+      key_sequence.due_ns = now_ns + step.delay_ms * 1000000ULL;
+    }
+  }
+}
+
+// earliest deadline of the mouse tick, key repeats and key sequence, 0 when nothing is scheduled
+Uint64 nextTimerDeadline()
+{
+  Uint64 deadline_ns = state.mouse_tick_ns;
+  if ((state.total_repeats > 0) && ((deadline_ns == 0) || (state.repeats[0].due_ns < deadline_ns))) {
+    deadline_ns = state.repeats[0].due_ns;
+  }
+  if ((key_sequence.due_ns != 0) && ((deadline_ns == 0) || (key_sequence.due_ns < deadline_ns))) {
+    deadline_ns = key_sequence.due_ns;
+  }
+  if (textInputRefreshPending() && ((deadline_ns == 0) || (state.text_input_refresh_ns < deadline_ns))) {
+    deadline_ns = std::max(state.text_input_refresh_ns, (Uint64)1);
+  }
+  return deadline_ns;
+}
+
+// called after every batch of input, so a stick leaving the deadzone moves the mouse straight away
+void runDueTimers(Uint64 now_ns)
+{
+  if (state.mouseX == 0 && state.mouseY == 0 && state.scrollX == 0 && state.scrollY == 0) {
+    state.mouse_tick_ns = 0; // sticks are back in the deadzone
+  } else if (state.mouse_tick_ns == 0) {
+    state.mouse_tick_ns = now_ns;
+  }
+  if ((state.mouse_tick_ns != 0) && (state.mouse_tick_ns <= now_ns)) {
+    mouseTick(now_ns);
+  }
+  repeatTick(now_ns);
+  if (textInputRefreshPending() && (state.text_input_refresh_ns <= now_ns)) {
+    beginLatencySample(LATENCY_TEXT, monotonicNanos());
+    showTextInputSelection();
+  }
+  runKeySequence(now_ns);
+}
+
+
+bool isHotkeyButton(int button)
+{
+  if ((button == SDL_CONTROLLER_BUTTON_BACK) && emuelec_override) {
+    return false;
+  }
+  if (hotkey_override) {
+    return button == hotkey_button;
+  }
+  return (button == SDL_CONTROLLER_BUTTON_BACK) || (button == SDL_CONTROLLER_BUTTON_GUIDE);
+}
+
+void enableKeyCode(struct libevdev* device, int code)
+{
+  if ((code > KEY_RESERVED) && (code <= KEY_MAX)) {
+    libevdev_enable_event_code(device, EV_KEY, code, NULL);
+  }
+}
+
+void enableKeyCodes(struct libevdev* device, const short* codes, int total_keys)
+{
+  for (int ii = 0; ii < std::max(total_keys, 1); ii++) {
+    enableKeyCode(device, codes[ii]);
+  }
+}
+
+// declare only the keys that the loaded config and enabled modes can emit
+void enableConfigKeys(struct libevdev* device)
+{
+  for (int input = 0; input < BINDING_INPUTS; input++) {
+    bool is_left_stick = (input >= INPUT_LEFT_ANALOG_UP) && (input <= INPUT_LEFT_ANALOG_RIGHT);
+    bool is_right_stick = (input >= INPUT_RIGHT_ANALOG_UP) && (input <= INPUT_RIGHT_ANALOG_RIGHT);
+    if ((is_left_stick && (config.left_analog_as_mouse || config.left_analog_as_scroll)) ||
+      (is_right_stick && (config.right_analog_as_mouse || config.right_analog_as_scroll))) {
+      continue; // the stick moves the mouse or scrolls instead
+    }
+    for (int layer = 0; layer < BINDING_LAYERS; layer++) {
+      const binding& bound = config.bindings[input][layer];
+      enableKeyCodes(device, bound.keys, bound.total_keys);
+      enableKeyCodes(device, bound.modifiers, bound.total_keys);
+    }
+  }
+
+  if (pckill_mode) {
+    enableKeyCode(device, KEY_F4);
+    enableKeyCode(device, KEY_LEFTALT);
+  }
+  if (textinputpreset_mode) {
+    enableKeyCode(device, KEY_ENTER);
+    enableKeyCode(device, KEY_LEFTSHIFT);
+    enableKeyCode(device, KEY_RIGHTALT);
+    if (text_input_preset != NULL) {
+      for (const char* text = text_input_preset; *text != '\0';) {
+        enableKeyCode(device, textKey(nextCodepoint(text)).code);
+      }
+    }
+    if (total_unicode_entry_keys > 0) {
+      enableKeyCodes(device, unicode_entry_keys, total_unicode_entry_keys);
+      for (const char* digit = "0123456789abcdef "; *digit != '\0'; digit++) {
+        enableKeyCode(device, text_keys[(unsigned char)*digit].code);
+      }
+    }
+  }
+  if (textinputinteractive_mode) {
+    enableKeyCode(device, KEY_ENTER);
+    enableKeyCode(device, KEY_BACKSPACE);
+    enableKeyCode(device, KEY_LEFTSHIFT);
+    for (int ii = 0; ii < maxKeys; ii++) {
+      enableKeyCode(device, character_set[ii].code);
+      if (character_set[ii].modifiers & TEXT_MOD_ALTGR) {
+        enableKeyCode(device, KEY_RIGHTALT);
+      }
+    }
+  }
+}
+
+void setupFakeKeyboardMouseDevice(struct libevdev* device)
+{
+  libevdev_set_name(device, "Fake Keyboard");
+  libevdev_set_id_vendor(device, 0x1234);  /* sample vendor */
+  libevdev_set_id_product(device, 0x5678); /* sample product */
+
+  // Keys or Buttons
+  libevdev_enable_event_type(device, EV_KEY);
+  libevdev_enable_event_type(device, EV_SYN);
+  enableConfigKeys(device);
+
+  // Fake mouse, only if something can move it or click with it
+  if (
+    config.left_analog_as_mouse || config.right_analog_as_mouse ||
+    libevdev_has_event_code(device, EV_KEY, BTN_LEFT) ||
+    libevdev_has_event_code(device, EV_KEY, BTN_RIGHT)) {
+    libevdev_enable_event_type(device, EV_REL);
+    libevdev_enable_event_code(device, EV_REL, REL_X, NULL);
+    libevdev_enable_event_code(device, EV_REL, REL_Y, NULL);
+    enableKeyCode(device, BTN_LEFT);
+    enableKeyCode(device, BTN_RIGHT);
+  }
+  if (config.left_analog_as_scroll || config.right_analog_as_scroll) {
+    libevdev_enable_event_type(device, EV_REL);
+    libevdev_enable_event_code(device, EV_REL, REL_WHEEL, NULL);
+    libevdev_enable_event_code(device, EV_REL, REL_HWHEEL, NULL);
+    libevdev_enable_event_code(device, EV_REL, REL_WHEEL_HI_RES, NULL);
+    libevdev_enable_event_code(device, EV_REL, REL_HWHEEL_HI_RES, NULL);
+  }
+}
+
+void setupFakeXbox360Device(struct libevdev* device)
+{
+  libevdev_set_name(device, "Microsoft X-Box 360 pad");
+  libevdev_set_id_vendor(device, 0x045e);  /* sample vendor */
+  libevdev_set_id_product(device, 0x028e); /* sample product */
+
+  const struct input_absinfo stick = {0, -32768, 32767, 16, 128, 0};
+  const struct input_absinfo hat = {0, -1, 1, 0, 0, 0};
+  const struct input_absinfo trigger = {0, 0, 255, 0, 0, 0};
+
+  if (
+    libevdev_enable_event_type(device, EV_KEY) || libevdev_enable_event_type(device, EV_SYN) ||
+    libevdev_enable_event_type(device, EV_ABS) ||
+    // X-Box 360 pad buttons
+    libevdev_enable_event_code(device, EV_KEY, BTN_A, NULL) || libevdev_enable_event_code(device, EV_KEY, BTN_B, NULL) ||
+    libevdev_enable_event_code(device, EV_KEY, BTN_X, NULL) || libevdev_enable_event_code(device, EV_KEY, BTN_Y, NULL) ||
+    libevdev_enable_event_code(device, EV_KEY, BTN_TL, NULL) || libevdev_enable_event_code(device, EV_KEY, BTN_TR, NULL) ||
+    libevdev_enable_event_code(device, EV_KEY, BTN_THUMBL, NULL) ||
+    libevdev_enable_event_code(device, EV_KEY, BTN_THUMBR, NULL) ||
+    libevdev_enable_event_code(device, EV_KEY, BTN_SELECT, NULL) ||
+    libevdev_enable_event_code(device, EV_KEY, BTN_START, NULL) || libevdev_enable_event_code(device, EV_KEY, BTN_MODE, NULL) ||
+    // absolute (sticks), ranges are passed to the kernel with UI_ABS_SETUP
+    libevdev_enable_event_code(device, EV_ABS, ABS_X, &stick) ||
+    libevdev_enable_event_code(device, EV_ABS, ABS_Y, &stick) ||
+    libevdev_enable_event_code(device, EV_ABS, ABS_RX, &stick) ||
+    libevdev_enable_event_code(device, EV_ABS, ABS_RY, &stick) ||
+    libevdev_enable_event_code(device, EV_ABS, ABS_Z, &trigger) ||
+    libevdev_enable_event_code(device, EV_ABS, ABS_RZ, &trigger) ||
+    libevdev_enable_event_code(device, EV_ABS, ABS_HAT0X, &hat) ||
+    libevdev_enable_event_code(device, EV_ABS, ABS_HAT0Y, &hat)) {
+    printf("Failed to configure fake Xbox 360 controller\n");
+    exit(-1);
+  }
+}
+
+int countKeyCodes(const struct libevdev* device)
+{
+  int total = 0;
+  for (int code = 0; code <= KEY_MAX; code++) {
+    if (libevdev_has_event_code(device, EV_KEY, code)) {
+      total++;
+    }
+  }
+  return total;
+}
+
+// pads share the fake keyboard: an input is pressed while any pad holds it, so one pad can't
+// release what another one still holds
+bool holdPadInput(pad_slot& pad, int input, bool is_pressed)
+{
+  if (pad.inputs_held[input] != is_pressed) {
+    pad.inputs_held[input] = is_pressed;
+    state.input_holders[input] += is_pressed ? 1 : -1;
+  }
+  return state.input_holders[input] > 0;
+}
+
+void handlePadInput(pad_slot& pad, int input, bool is_pressed)
+{
+  handleBinding(input, holdPadInput(pad, input, is_pressed));
+}
+
+// in xbox360 mode a report goes to one fake pad, so switching pads closes the previous one's report
+void emitToPad(pad_slot& pad)
+{
+  if ((pad.uinput_fd >= 0) && (pad.uinput_fd != emit_fd)) {
+    flushEmitBatch();
+    emit_fd = pad.uinput_fd;
+    held = (pad.uinput == uinput_device) ? &device_ledger : &pad.ledger;
+  }
+}
+
+// the fake pad created at startup is player one's, the others are created as their controllers appear
+void createFakePad(pad_slot& pad)
+{
+  if (!xbox360_mode || (uinput_description == NULL)) {
+    return; // config mode, or a replayed trace
+  }
+  if (&pad == &pads[0]) {
+    pad.uinput = uinput_device;
+    pad.uinput_fd = uinp_fd;
+    return;
+  }
+  pad.uinput_fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+  if ((pad.uinput_fd < 0) || (libevdev_uinput_create_from_device(uinput_description, pad.uinput_fd, &pad.uinput) != 0)) {
+    printf("Unable to create UINPUT device for controller %d\n", pad.instance_id);
+    if (pad.uinput_fd >= 0) {
+      close(pad.uinput_fd);
+    }
+    pad.uinput = NULL;
+    pad.uinput_fd = -1; // its input goes to the previous pad's device
+    return;
+  }
+  printf("controller %d has fake Xbox 360 pad %s\n", pad.instance_id, libevdev_uinput_get_devnode(pad.uinput));
+}
+
+pad_slot* findPadSlot(SDL_JoystickID instance_id)
+{
+  for (int probe = 0; probe < PAD_SLOT_MAP; probe++) {
+    int entry = pad_slot_map[(instance_id + probe) & (PAD_SLOT_MAP - 1)];
+    if (entry == 0) {
+      return NULL;
+    } else if (pads[entry - 1].instance_id == instance_id) {
+      return &pads[entry - 1];
+    }
+  }
+  return NULL;
+}
+
+void mapPadSlot(int slot)
+{
+  for (int probe = 0; probe < PAD_SLOT_MAP; probe++) {
+    Sint8& entry = pad_slot_map[(pads[slot].instance_id + probe) & (PAD_SLOT_MAP - 1)];
+    if (entry == 0) {
+      entry = slot + 1;
+      return;
+    }
+  }
+}
+
+// the slot of a controller, taken when its first event arrives so that traces and -evdev pads need no
+// device added event; NULL when every slot is taken, the controller is then ignored
+pad_slot* padSlot(SDL_JoystickID instance_id)
+{
+  if (pad_slot* pad = findPadSlot(instance_id)) {
+    return pad;
+  }
+  for (int slot = 0; slot < PAD_SLOTS; slot++) {
+    if (!pads[slot].in_use) {
+      pads[slot].in_use = true;
+      pads[slot].instance_id = instance_id;
+      mapPadSlot(slot);
+      createFakePad(pads[slot]);
+      return &pads[slot];
+    }
+  }
+  static SDL_JoystickID ignored_id = -1; // reported once, not on every event
+  if (ignored_id != instance_id) {
+    printf("more than %d controllers, ignoring controller %d\n", PAD_SLOTS, instance_id);
+    ignored_id = instance_id;
+  }
+  return NULL;
+}
+
+// a controller is gone: whatever it held is released and its slot is free for the next one
+void releasePadSlot(SDL_JoystickID instance_id)
+{
+  pad_slot* pad = findPadSlot(instance_id);
+  if (pad == NULL) {
+    return;
+  }
+  if (!xbox360_mode) {
+    for (int input = 0; input < BINDING_INPUTS; input++) {
+      if (pad->inputs_held[input]) {
+        handlePadInput(*pad, input, false);
+      }
+    }
+    state.hotkey_pressed = false;
+    for (int button = 0; button < SDL_CONTROLLER_BUTTON_MAX; button++) {
+      state.hotkey_pressed = state.hotkey_pressed || (isHotkeyButton(button) && (state.input_holders[button] > 0));
+    }
+  } else if (pad->uinput != NULL) {
+    emitToPad(*pad);
+    releaseHeldKeys(); // its fake pad lets go of every button, stick and d-pad
+  }
+  flushEmitBatch();
+  if (pad->uinput_fd == emit_fd) {
+    emit_fd = uinp_fd;
+    held = &device_ledger;
+  }
+  if ((pad->uinput != NULL) && (pad->uinput != uinput_device)) {
+    libevdev_uinput_destroy(pad->uinput);
+    close(pad->uinput_fd);
+  }
+  if (pad->controller != NULL) {
+    SDL_GameControllerClose(pad->controller);
+  }
+  *pad = pad_slot();
+
+  memset(pad_slot_map, 0, sizeof(pad_slot_map)); // no tombstones, the few slots left are mapped again
+  for (int slot = 0; slot < PAD_SLOTS; slot++) {
+    if (pads[slot].in_use) {
+      mapPadSlot(slot);
+    }
+  }
+}
+
+// forget what the inputs pressed, when the mapping changes or text input takes over; keys and repeats
+// started before would otherwise never see their release
+void releaseHeldInputs()
+{
+  for (int input = 0; input < BINDING_INPUTS; input++) {
+    stopRepeat(input); // interactive text input keeps its own
+  }
+  state.mouseX = state.mouseY = 0;
+  state.scrollX = state.scrollY = 0;
+  state.mouse_remainder_x = state.mouse_remainder_y = 0;
+  state.scroll_remainder_x = state.scroll_remainder_y = 0;
+  state.scroll_notch_x = state.scroll_notch_y = 0;
+  // sticks and triggers still deflected press their new key with their next movement, cycles start over
+  memset(state.bindings, 0, sizeof(state.bindings));
+}
+
+// SDL sees our own fake pads as controllers too, they are told apart by the version gptokeyb gives them
+bool isFakePad(int device_index)
+{
+  return (SDL_JoystickGetDeviceVendor(device_index) == 0x045e) && (SDL_JoystickGetDeviceProduct(device_index) == 0x028e) &&
+    (SDL_JoystickGetDeviceProductVersion(device_index) == 1);
+}
+
+// Input traces: the controller events seen by handleEvent() as fixed size little-endian records
+// after an 8 byte magic, so a session can be replayed without a gamepad or /dev/uinput
+#define TRACE_MAGIC "GPTKTRC1"
+
+struct trace_record
+{
+  Uint32 timestamp; // milliseconds, SDL_GetTicks() time base
+  Sint32 which; // joystick instance id
+  Uint16 type; // SDL event type
+  Sint16 value; // axis value, or 1/0 for button down/up
+  Uint8 element; // SDL_GameControllerButton or SDL_GameControllerAxis
+  Uint8 reserved[3];
+};
+
+void recordTraceEvent(const SDL_Event& event)
+{
+  trace_record record;
+  memset(&record, 0, sizeof(record));
+  record.timestamp = event.common.timestamp;
+  record.type = event.type;
+
+  switch (event.type) {
+    case SDL_CONTROLLERBUTTONDOWN:
+    case SDL_CONTROLLERBUTTONUP:
+      record.which = event.cbutton.which;
+      record.element = event.cbutton.button;
+      record.value = (event.type == SDL_CONTROLLERBUTTONDOWN);
+      break;
+    case SDL_CONTROLLERAXISMOTION:
+      record.which = event.caxis.which;
+      record.element = event.caxis.axis;
+      record.value = event.caxis.value;
+      break;
+    case SDL_CONTROLLERDEVICEADDED:
+    case SDL_CONTROLLERDEVICEREMOVED:
+      record.which = event.cdevice.which;
+      break;
+    case SDL_QUIT:
+      break;
+    default:
+      return;
+  }
+  fwrite(&record, sizeof(record), 1, trace_record_file);
+  fflush(trace_record_file); // keep the trace usable if we are killed
+}
+
+// kill mode: the app is found by scanning /proc and signalled through a pidfd, so a pid reused
+// after the scan is never hit, then polled until it exits instead of sleeping a fixed time
+struct app_process
+{
+  pid_t pid;
+  int pidfd; // -1 on kernels without pidfd_open (before 5.3), the pid is signalled instead
+};
+
+// reads /proc/<pid>/<file> into buffer as a string, returns the length or -1
+ssize_t readProcFile(const char* pid, const char* file, char* buffer, size_t size)
+{
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/%s/%s", pid, file);
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  ssize_t length = read(fd, buffer, size - 1);
+  close(fd);
+  if (length < 0) {
+    return -1;
+  }
+  buffer[length] = '\0';
+  return length;
+}
+
+// matches the process name like killall, or the basename of argv[0] like pidof
+bool isAppToKill(const char* pid)
+{
+  char name[PATH_MAX];
+  if (readProcFile(pid, "comm", name, sizeof(name)) > 0) {
+    name[strcspn(name, "\n")] = '\0';
+    if (strcmp(name, AppToKill) == 0) {
+      return true;
+    }
+  }
+  if (readProcFile(pid, "cmdline", name, sizeof(name)) <= 0) {
+    return false; // kernel thread or already gone
+  }
+  const char* base = strrchr(name, '/'); // argv[0] ends at the first NUL
+  return strcmp(base ? base + 1 : name, AppToKill) == 0;
+}
+
+void signalApp(const app_process& process, int signal)
+{
+  if (process.pidfd >= 0) {
+    syscall(SYS_pidfd_send_signal, process.pidfd, signal, NULL, 0);
+  } else {
+    kill(process.pid, signal);
+  }
+}
+
+// collects the exit status of the launched app, returns whether it has exited
+bool reapLaunchedApp()
+{
+  int status;
+  if (!launched.exited && (waitpid(launched.pid, &status, WNOHANG) == launched.pid)) {
+    launched.exited = true;
+    launched.exit_status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    printf("%s exited with status %d\n", AppToKill, launched.exit_status);
+  }
+  return launched.exited;
+}
+
+bool appExited(const app_process& process)
+{
+  if (process.pid == launched.pid) {
+    return reapLaunchedApp(); // our child stays a zombie until it is reaped
+  }
+  if (process.pidfd >= 0) {
+    struct pollfd exit_poll = {process.pidfd, POLLIN, 0}; // a pidfd is readable once its process has exited
+    return poll(&exit_poll, 1, 0) > 0;
+  }
+  return (kill(process.pid, 0) < 0) && (errno == ESRCH);
+}
+
+// waits until every process has exited or timeout_ms has passed, returns whether they all exited
+bool waitForApp(std::vector<app_process>& processes, int timeout_ms)
+{
+  Uint64 deadline_ns = monotonicNanos() + timeout_ms * 1000000ULL;
+  std::vector<struct pollfd> exit_polls;
+  while (true) {
+    for (size_t ii = 0; ii < processes.size();) {
+      if (appExited(processes[ii])) {
+        if (processes[ii].pidfd >= 0) {
+          close(processes[ii].pidfd);
+        }
+        processes.erase(processes.begin() + ii);
+      } else {
+        ii++;
+      }
+    }
+    Uint64 now_ns = monotonicNanos();
+    if (processes.empty() || (now_ns >= deadline_ns)) {
+      return processes.empty();
+    }
+
+    int wait_ms = (deadline_ns - now_ns + 999999) / 1000000;
+    exit_polls.clear();
+    for (const app_process& process : processes) {
+      if (process.pidfd >= 0) {
+        exit_polls.push_back({process.pidfd, POLLIN, 0});
+      } else {
+        wait_ms = std::min(wait_ms, 10); // nothing tells us when a pid exits, check it again soon
+      }
+    }
+    poll(exit_polls.data(), exit_polls.size(), wait_ms);
+  }
+}
+
+pid_t splash_pid = -1;
+
+// runs show_splash.sh without waiting for it, so the splash doesn't delay the kill
+void showExitSplash()
+{
+  char* const splash_argv[] = {(char*)"show_splash.sh", (char*)"exit", NULL};
+  posix_spawnattr_t splash_attr;
+  posix_spawnattr_init(&splash_attr);
+  sigset_t no_signals;
+  sigemptyset(&no_signals);
+  posix_spawnattr_setsigmask(&splash_attr, &no_signals); // ours blocks SIGTERM and SIGINT for the event loop
+  posix_spawnattr_setflags(&splash_attr, POSIX_SPAWN_SETSIGMASK);
+  if (posix_spawnp(&splash_pid, splash_argv[0], NULL, &splash_attr, splash_argv, environ) != 0) {
+    splash_pid = -1;
+  }
+  posix_spawnattr_destroy(&splash_attr);
+}
+
+// a splash still showing is left to init, which adopts it when we exit
+void reapExitSplash()
+{
+  if ((splash_pid > 0) && (waitpid(splash_pid, NULL, WNOHANG) != 0)) {
+    splash_pid = -1;
+  }
+}
+
+// a child cgroup of our own for the launched app, returns its cgroup.procs opened for writing or -1
+int createLaunchCgroup()
+{
+  char own[PATH_MAX];
+  if (readProcFile("self", "cgroup", own, sizeof(own)) <= 0) {
+    return -1;
+  }
+  char* path = (strncmp(own, "0::", 3) == 0) ? own : strstr(own, "\n0::"); // the cgroup2 hierarchy
+  if (path == NULL) {
+    return -1;
+  }
+  path = strchr(path, '/');
+  path[strcspn(path, "\n")] = '\0';
+
+  const char* mounts[] = {"/sys/fs/cgroup", "/sys/fs/cgroup/unified"}; // unified is the hybrid layout
+  for (const char* mount : mounts) {
+    std::string parent = std::string(mount) + ((strcmp(path, "/") == 0) ? "" : path);
+    if (access((parent + "/cgroup.procs").c_str(), W_OK) != 0) {
+      continue;
+    }
+    std::string cgroup = parent + "/gptokeyb-" + std::to_string(getpid());
+    if (mkdir(cgroup.c_str(), 0755) != 0) {
+      printf("can't create cgroup %s: %s\n", cgroup.c_str(), strerror(errno));
+      return -1;
+    }
+    int procs_fd = open((cgroup + "/cgroup.procs").c_str(), O_WRONLY | O_CLOEXEC);
+    if (procs_fd < 0) {
+      rmdir(cgroup.c_str());
+      return -1;
+    }
+    launched.cgroup = cgroup;
+    return procs_fd;
+  }
+  return -1;
+}
+
+// signal every process the launched app started: SIGKILL in one step through cgroup.kill (5.14), else
+// each pid in the cgroup, else its process group
+void signalLaunchedTree(int signal)
+{
+  if (!launched.cgroup.empty()) {
+    int kill_fd = (signal == SIGKILL) ? open((launched.cgroup + "/cgroup.kill").c_str(), O_WRONLY | O_CLOEXEC) : -1;
+    if (kill_fd >= 0) {
+      bool killed = (write(kill_fd, "1", 1) == 1);
+      close(kill_fd);
+      if (killed) {
+        return;
+      }
+    }
+    if (FILE* procs = fopen((launched.cgroup + "/cgroup.procs").c_str(), "re")) {
+      int pid;
+      while (fscanf(procs, "%d", &pid) == 1) {
+        kill(pid, signal);
+      }
+      fclose(procs);
+      return;
+    }
+  }
+  kill(-launched.pid, signal);
+}
+
+// true once nothing the launched app started is left, after waiting up to timeout_ms; the app itself has to be reaped already
+bool launchedTreeGone(int timeout_ms)
+{
+  Uint64 deadline_ns = monotonicNanos() + timeout_ms * 1000000ULL;
+  int events_fd = launched.cgroup.empty() ? -1 : open((launched.cgroup + "/cgroup.events").c_str(), O_RDONLY | O_CLOEXEC);
+  bool gone = false;
+  while (true) {
+    if (events_fd >= 0) {
+      char events[256];
+      ssize_t length = pread(events_fd, events, sizeof(events) - 1, 0); // also rearms the notification
+      events[std::max<ssize_t>(length, 0)] = '\0';
+      gone = (strstr(events, "populated 0") != NULL);
+    } else {
+      gone = (kill(-launched.pid, 0) != 0); // the group id stays taken while any member is left
+    }
+    Uint64 now_ns = monotonicNanos();
+    if (gone || (now_ns >= deadline_ns)) {
+      break;
+    }
+    if (events_fd >= 0) {
+      struct pollfd events_poll = {events_fd, POLLPRI, 0}; // cgroup.events flags POLLPRI when it changes
+      poll(&events_poll, 1, (deadline_ns - now_ns + 999999) / 1000000);
+    } else {
+      SDL_Delay(10);
+    }
+  }
+  if (events_fd >= 0) {
+    close(events_fd);
+  }
+  return gone;
+}
+
+// the cgroup can only be removed once it is empty, which is waited for up to timeout_ms
+void removeLaunchCgroup(int timeout_ms)
+{
+  if (launched.cgroup.empty()) {
+    return;
+  }
+  launchedTreeGone(timeout_ms);
+  if (rmdir(launched.cgroup.c_str()) != 0) {
+    printf("can't remove cgroup %s: %s\n", launched.cgroup.c_str(), strerror(errno));
+  }
+  launched.cgroup.clear();
+}
+
+void killLaunchedApp()
+{
+  Uint64 start_ns = monotonicNanos();
+  std::vector<app_process> processes = {{launched.pid, launched.pidfd}};
+  if (!sudo_kill) {
+    signalApp(processes[0], SIGTERM);
+    showExitSplash();
+    if (!waitForApp(processes, kill_grace_ms)) {
+      printf("Forcefully Killing: %s\n", AppToKill);
+    }
+  }
+  signalLaunchedTree(SIGKILL); // whatever it left running, or all of it for -sudokill
+  waitForApp(processes, kill_grace_ms);
+  removeLaunchCgroup(kill_grace_ms);
+  printf("%s exited %.1f ms after the kill\n", AppToKill, (monotonicNanos() - start_ns) / 1e6);
+}
+
+// closes AppToKill with SIGTERM, or SIGKILL right away for -sudokill, and SIGKILL when it is
+// still running after kill_grace_ms
+void killApp()
+{
+  if (launched.pid > 0) {
+    killLaunchedApp();
+    return;
+  }
+  Uint64 start_ns = monotonicNanos();
+  std::vector<app_process> processes;
+  if (DIR* proc = opendir("/proc")) {
+    pid_t own_pid = getpid();
+    while (struct dirent* entry = readdir(proc)) {
+      char* end;
+      pid_t pid = strtol(entry->d_name, &end, 10);
+      if ((*end != '\0') || (pid <= 0) || (pid == own_pid) || !isAppToKill(entry->d_name)) {
+        continue;
+      }
+      int pidfd = syscall(SYS_pidfd_open, pid, 0);
+      if ((pidfd < 0) && (errno != ENOSYS)) {
+        continue; // exited since the scan, its pid may already belong to another process
+      }
+      if ((pidfd >= 0) && !isAppToKill(entry->d_name)) { // the pid was reused since the scan
+        close(pidfd);
+        continue;
+      }
+      processes.push_back({pid, pidfd});
+    }
+    closedir(proc);
+  }
+  if (processes.empty()) {
+    printf("Not running: %s\n", AppToKill);
+    return;
+  }
+
+  for (const app_process& process : processes) {
+    signalApp(process, sudo_kill ? SIGKILL : SIGTERM);
+  }
+  if (!sudo_kill) {
+    showExitSplash();
+  }
+  if (!waitForApp(processes, kill_grace_ms)) {
+    printf("Forcefully Killing: %s\n", AppToKill);
+    for (const app_process& process : processes) {
+      signalApp(process, SIGKILL);
+    }
+    waitForApp(processes, kill_grace_ms);
+  }
+  printf("%s exited %.1f ms after the kill\n", AppToKill, (monotonicNanos() - start_ns) / 1e6);
+}
+
+bool handleEvent(const SDL_Event& event)
+{
+  if (trace_record_file != NULL) {
+    recordTraceEvent(event);
+  }
+
+  if ((event.type == SDL_CONTROLLERBUTTONDOWN) || (event.type == SDL_CONTROLLERBUTTONUP)) {
+    beginLatencySample(state.textinputinteractive_mode_active ? LATENCY_TEXT : LATENCY_BUTTON, latencyStartNanos(event));
+  } else if (event.type == SDL_CONTROLLERAXISMOTION) {
+    beginLatencySample(LATENCY_AXIS, latencyStartNanos(event));
+  }
+
+  switch (event.type) {
+    case SDL_CONTROLLERBUTTONDOWN:
+    case SDL_CONTROLLERBUTTONUP: {
+      const bool is_pressed = event.type == SDL_CONTROLLERBUTTONDOWN;
+      pad_slot* pad_ptr = padSlot(event.cbutton.which);
+      if (pad_ptr == NULL) {
+        break;
+      }
+      pad_slot& pad = *pad_ptr;
+
+        if (state.textinputinteractive_mode_active) {
+        int button = event.cbutton.button;
+        short direction = textInputDirection(button);
+        if (config.text_input_grid_rows > 0) {
+          if (direction != 0) { // the d-pad moves on the virtual keyboard
+            if (is_pressed) {
+              stepTextInputSelection(direction);
+            }
+            setInputRepeat(direction, is_pressed);
+            button = SDL_CONTROLLER_BUTTON_INVALID;
+          } else if (button == SDL_CONTROLLER_BUTTON_LEFTSHOULDER) { // and the shoulder buttons move the cursor
+            button = SDL_CONTROLLER_BUTTON_DPAD_LEFT;
+          } else if (button == SDL_CONTROLLER_BUTTON_RIGHTSHOULDER) {
+            button = SDL_CONTROLLER_BUTTON_DPAD_RIGHT;
+          }
+        }
+        if (is_pressed && (button != SDL_CONTROLLER_BUTTON_INVALID) && (button != SDL_CONTROLLER_BUTTON_DPAD_UP) && (button != SDL_CONTROLLER_BUTTON_DPAD_DOWN) &&
+            (button != SDL_CONTROLLER_BUTTON_LEFTSHOULDER) && (button != SDL_CONTROLLER_BUTTON_RIGHTSHOULDER)) {
+          commitTextInputSelection(); // what was scrolled to is typed before the cursor moves or the text is confirmed
+        }
+        switch (button) {
+          case SDL_CONTROLLER_BUTTON_DPAD_LEFT: //move back one character
+            if (is_pressed) {
+              removeTextInputCharacter();
+              if (current_character > 0) {
+                current_character--;
+              } else if (current_character == 0) {
+                removeTextInputCharacter();
+                initialiseCharacters();
+                addTextInputCharacter();
+              }
+            }
+            break; // SDL_CONTROLLER_BUTTON_DPAD_LEFT
+            
+          case SDL_CONTROLLER_BUTTON_DPAD_RIGHT: //add one more character
+            if (is_pressed) {
+              if ((character_set[current_key[current_character]].code == KEY_SPACE) && (!(textinputinteractive_noautocapitals))) {
+                current_key[++current_character] = 0; // use capitals after a space
+              } else {
+                current_character++;
+              }
+              if (current_character < maxChars) {
+                addTextInputCharacter();
+              } else { // reached limit of characters
+                confirmTextInputCharacter();
+                state.textinputinteractive_mode_active = false;
+                printf("text input interactive mode no longer active\n");
+              }
+            }
+            break; //SDL_CONTROLLER_BUTTON_DPAD_RIGHT
+            
+          case SDL_CONTROLLER_BUTTON_DPAD_UP: //select previous key
+            if (is_pressed) {
+                prevTextInputKey(true);  
+                setInputRepeat(KEY_UP, true);        
+            } else {
+                setInputRepeat(KEY_UP, false);
+            }
+            break; //SDL_CONTROLLER_BUTTON_DPAD_UP
+            
+          case SDL_CONTROLLER_BUTTON_DPAD_DOWN:  //select next key
+            if (is_pressed) {
+                nextTextInputKey(true);
+                setInputRepeat(KEY_DOWN, true);        
+            } else {
+                setInputRepeat(KEY_DOWN, false);
+            }
+            break; //SDL_CONTROLLER_BUTTON_DPAD_DOWN
+            
+          case SDL_CONTROLLER_BUTTON_LEFTSHOULDER: //jump back by 13 letters
+            if (is_pressed) {
+                prevTextInputKey(false); //jump back by 13 letters
+                setInputRepeat(KEY_UP, false); //disable key repeat  
+            } else {
+                setInputRepeat(KEY_UP, false);
+            }
+            break; //SDL_CONTROLLER_BUTTON_LEFTSHOULDER
+            
+          case SDL_CONTROLLER_BUTTON_RIGHTSHOULDER:  //jump forward by 13 letters
+            if (is_pressed) {
+                nextTextInputKey(false); //jump forward by 13 letters
+                setInputRepeat(KEY_DOWN, false); //disable key repeat        
+            } else {
+                setInputRepeat(KEY_DOWN, false);
+            }
+            break; //SDL_CONTROLLER_BUTTON_RIGHTSHOULDER
+
+          case SDL_CONTROLLER_BUTTON_A: //A buttons sends ENTER KEY
+            if (is_pressed) {
+              confirmTextInputCharacter();
+              //disable interactive mode
+              state.textinputinteractive_mode_active = false;
+              printf("text input interactive mode no longer active\n");
+            }
+            break; //SDL_CONTROLLER_BUTTON_A
+
+          case SDL_CONTROLLER_BUTTON_LEFTSTICK: // hotkey override
+          case SDL_CONTROLLER_BUTTON_BACK: // aka select
+            if (is_pressed) { // cancel key input and disable interactive input mode
+              for( int ii = 0; ii <= current_character; ii++ ) {
+                removeTextInputCharacter(); // delete all characters
+                if ((character_set[current_key[current_character]].code == KEY_SPACE) && app_exult_adjust) {
+                  removeTextInputCharacter(); //remove extra spaces            
+                }
+              }
+              initialiseCharacters(); //reset the character selections ready for new text to be added later
+              state.textinputinteractive_mode_active = false;
+              printf("text input interactive mode no longer active\n");
+            }
+            break; //SDL_CONTROLLER_BUTTON_BACK
+            
+          case SDL_CONTROLLER_BUTTON_START:
+            if (is_pressed) { 
+              confirmTextInputCharacter(); // send ENTER key to confirm text entry
+              //disable interactive mode
+              state.textinputinteractive_mode_active = false;
+              printf("text input interactive mode no longer active\n");
+            }
+            break; //SDL_CONTROLLER_BUTTON_START
+            
+          }   //switch (event.cbutton.button) for textinputinteractive_mode_active     
+      } else if (xbox360_mode) {
+        // Fake Xbox360 mode
+        emitToPad(pad);
+        switch (event.cbutton.button) {
+          case SDL_CONTROLLER_BUTTON_A:
+            emitKey(BTN_A, is_pressed);
+            break;
+
+          case SDL_CONTROLLER_BUTTON_B:
+            emitKey(BTN_B, is_pressed);
+            break;
+
+          case SDL_CONTROLLER_BUTTON_X:
+            emitKey(BTN_X, is_pressed);
+            break;
+
+          case SDL_CONTROLLER_BUTTON_Y:
+            emitKey(BTN_Y, is_pressed);
+            break;
+
+          case SDL_CONTROLLER_BUTTON_LEFTSHOULDER:
+            emitKey(BTN_TL, is_pressed);
+            break;
+
+          case SDL_CONTROLLER_BUTTON_RIGHTSHOULDER:
+            emitKey(BTN_TR, is_pressed);
+            break;
+
+          case SDL_CONTROLLER_BUTTON_LEFTSTICK:
+            emitKey(BTN_THUMBL, is_pressed);
+            if (kill_mode && isHotkeyButton(SDL_CONTROLLER_BUTTON_LEFTSTICK)) {
+                pad.hotkey_pressed = is_pressed;
+            }
+            break;
+
+          case SDL_CONTROLLER_BUTTON_RIGHTSTICK:
+            emitKey(BTN_THUMBR, is_pressed);
+            break;
+
+          case SDL_CONTROLLER_BUTTON_BACK: // aka select
+            emitKey(BTN_SELECT, is_pressed);
+            if (kill_mode && isHotkeyButton(SDL_CONTROLLER_BUTTON_BACK)) {
+              pad.hotkey_pressed = is_pressed;
+            }
+            break;
+
+          case SDL_CONTROLLER_BUTTON_GUIDE:
             emitKey(BTN_MODE, is_pressed);
-            if ((kill_mode && !(hotkey_override)) || (kill_mode && hotkey_override && (strcmp(hotkey_code, "guide") == 0))) {
-              state.hotkey_jsdevice = event.cdevice.which;
-              state.hotkey_pressed = is_pressed;
+            if (kill_mode && isHotkeyButton(SDL_CONTROLLER_BUTTON_GUIDE)) {
+              pad.hotkey_pressed = is_pressed;
+            }
+            break;
+
+          case SDL_CONTROLLER_BUTTON_START:
+            emitKey(BTN_START, is_pressed);
+            if ((kill_mode) || (textinputpreset_mode) || (textinputinteractive_mode)) {
+              pad.start_pressed = is_pressed;
+            }
+            break;
+
+          case SDL_CONTROLLER_BUTTON_DPAD_UP:
+            emitAxisMotion(ABS_HAT0Y, is_pressed ? -1 : 0);
+            break;
+
+          case SDL_CONTROLLER_BUTTON_DPAD_DOWN:
+            emitAxisMotion(ABS_HAT0Y, is_pressed ? 1 : 0);
+            break;
+
+          case SDL_CONTROLLER_BUTTON_DPAD_LEFT:
+            emitAxisMotion(ABS_HAT0X, is_pressed ? -1 : 0);
+            break;
+
+          case SDL_CONTROLLER_BUTTON_DPAD_RIGHT:
+            emitAxisMotion(ABS_HAT0X, is_pressed ? 1 : 0);
+            break;
+        }
+         if ((kill_mode) && (pad.start_pressed && pad.hotkey_pressed)) {      
+          if (pckill_mode) {
+            emitKey(KEY_F4,true,KEY_LEFTALT);
+            emitPause(15);
+            emitKey(KEY_F4,false,KEY_LEFTALT);
+          }
+          flushEmitBatch();
+          if (trace_replay_file == NULL) { // replaying into memory ends the trace rather than signal real processes
+            killApp();
+          }
+          return false; // stops the event loop like SDL_QUIT, so the fake devices are still released
+        } //kill mode
+      // xbox360 mode
+      } else { //config mode (i.e. not textinputinteractive_mode_active)
+        const int button = event.cbutton.button;
+        bool is_text_input_trigger = false; // pressed with start, for a text input combo instead of its key
+        if (textinputpreset_mode && (button == SDL_CONTROLLER_BUTTON_DPAD_LEFT)) { //check if input preset mode is triggered
+          pad.textinputpresettrigger_pressed = is_pressed;
+          is_text_input_trigger = pad.start_pressed && is_pressed;
+        } else if (textinputpreset_mode && (button == SDL_CONTROLLER_BUTTON_DPAD_RIGHT)) { //check if input preset enter_press is triggered
+          pad.textinputconfirmtrigger_pressed = is_pressed;
+          is_text_input_trigger = pad.start_pressed && is_pressed;
+        } else if (textinputinteractive_mode && (button == SDL_CONTROLLER_BUTTON_DPAD_DOWN)) {
+          pad.textinputinteractivetrigger_pressed = is_pressed;
+          is_text_input_trigger = pad.start_pressed && is_pressed;
+        }
+
+        if (isHotkeyButton(button)) {
+          pad.hotkey_pressed = is_pressed;
+          state.hotkey_pressed = holdPadInput(pad, button, is_pressed);
+          handleComboButton(button, state.hotkey_pressed, state.hotkey_pressed,
+            state.hotkey_was_pressed, state.hotkey_combo_triggered);
+        } else if (button == SDL_CONTROLLER_BUTTON_START) {
+          bool start_held = holdPadInput(pad, button, is_pressed);
+          bool start_combos = (kill_mode) || (textinputpreset_mode) || (textinputinteractive_mode);
+          if (start_combos) {
+            pad.start_pressed = is_pressed;
+          } // start pressed - ready for text input modes if trigger is also pressed
+          handleComboButton(button, start_held, start_combos && start_held,
+            state.start_was_pressed, state.start_combo_triggered);
+        } else if (!is_text_input_trigger && (button < INPUT_LEFT_ANALOG_UP)) {
+          handlePadInput(pad, button, is_pressed);
+        }
+        if ((kill_mode) && (pad.start_pressed && pad.hotkey_pressed)) {
+          if (pckill_mode) {
+            emitKey(KEY_F4,true,KEY_LEFTALT);
+            emitPause(15);
+            emitKey(KEY_F4,false,KEY_LEFTALT);
+          }
+          flushEmitBatch();
+          stopAllRepeats();
+          if (trace_replay_file == NULL) { // replaying into memory ends the trace rather than signal real processes
+            killApp();
+          }
+          return false; // stops the event loop like SDL_QUIT, so the fake devices are still released
+        } //kill mode 
+        else if ((textinputpreset_mode) && (pad.textinputpresettrigger_pressed && pad.start_pressed)) { //activate input preset mode - send predefined text as a series of keystrokes
+            printf("text input preset pressed\n");
+            state.start_combo_triggered = true;
+            if (text_input_preset != NULL) {
+                printf("text input processing %s\n", text_input_preset);
+                processKeys();
             }
+            pad.textinputpresettrigger_pressed = false; //reset textinputpreset trigger
+            pad.start_pressed = false;
+         } //input preset trigger mode (i.e. not kill mode)
+        else if ((textinputpreset_mode) && (pad.textinputconfirmtrigger_pressed && pad.start_pressed)) { //activate input preset confirm mode - send ENTER key
+            printf("text input confirm pressed\n");
+            state.start_combo_triggered = true;
+            printf("text input Enter key\n");
+            emitTextInputKey(KEY_ENTER, false);
+            pad.textinputconfirmtrigger_pressed = false; //reset textinputpreset confirm trigger
+            pad.start_pressed = false;
+          } //input confirm trigger mode (i.e. not kill mode)         
+        else if ((textinputinteractive_mode) && (pad.textinputinteractivetrigger_pressed && pad.start_pressed)) { //activate interactive text input mode
+            printf("text input interactive pressed\n");
+            state.start_combo_triggered = true;
+            printf("text input interactive mode active\n");
+            state.textinputinteractive_mode_active = true;
+            stopAllRepeats(); // disable any active key repeat
+            releaseHeldInputs();
+            releaseHeldKeys(); // nothing held for the game stays down while typing
+            current_character = 0;
+
+            addTextInputCharacter();
+            pad.textinputinteractivetrigger_pressed = false; //reset interactive text input mode trigger
+            pad.start_pressed = false;
+          } //input interactive trigger mode (i.e. not kill mode)
+      }  //xbox or config/default
+    } break; // case SDL_CONTROLLERBUTTONUP: SDL_CONTROLLERBUTTONDOWN:
+
+    case SDL_CONTROLLERAXISMOTION: {
+      pad_slot* pad_ptr = padSlot(event.caxis.which);
+      if (pad_ptr == NULL) {
+        break;
+      }
+      pad_slot& pad = *pad_ptr;
+      if (xbox360_mode) {
+        emitToPad(pad);
+        switch (event.caxis.axis) {
+          case SDL_CONTROLLER_AXIS_LEFTX:
+            emitAxisMotion(ABS_X, event.caxis.value);
+            break; 
+
+          case SDL_CONTROLLER_AXIS_LEFTY:
+            emitAxisMotion(ABS_Y, event.caxis.value);
+            break;
+
+          case SDL_CONTROLLER_AXIS_RIGHTX:
+            emitAxisMotion(ABS_RX, event.caxis.value);
+            break;
+
+          case SDL_CONTROLLER_AXIS_RIGHTY:
+            emitAxisMotion(ABS_RY, event.caxis.value);
+            break;
+
+          case SDL_CONTROLLER_AXIS_TRIGGERLEFT:
+            // The target range for the triggers is 0..255 instead of
+            // 0..32767, so we shift down by 7 as that does exactly the
+            // scaling we need (32767 >> 7 is 255)
+            emitAxisMotion(ABS_Z, event.caxis.value >> 7);
+            break;
+
+          case SDL_CONTROLLER_AXIS_TRIGGERRIGHT:
+            emitAxisMotion(ABS_RZ, event.caxis.value >> 7);
+            break;
+        }
+      } else {
+        // indicate which axis was moved before checking whether it's assigned as mouse
+        bool left_axis_movement = false;
+        bool right_axis_movement = false;
+        
+        switch (event.caxis.axis) {
+          case SDL_CONTROLLER_AXIS_LEFTX:
+            pad.current_left_analog_x =
+              applyDeadzone(event.caxis.value, config.deadzone_x);
+              left_axis_movement = true;
+            break;
+
+          case SDL_CONTROLLER_AXIS_LEFTY:
+            pad.current_left_analog_y =
+              applyDeadzone(event.caxis.value, config.deadzone_y);
+              left_axis_movement = true;
+            break;
+
+          case SDL_CONTROLLER_AXIS_RIGHTX:
+            pad.current_right_analog_x =
+              applyDeadzone(event.caxis.value, config.deadzone_x);
+              right_axis_movement = true;
+            break;
+
+          case SDL_CONTROLLER_AXIS_RIGHTY:
+            pad.current_right_analog_y =
+              applyDeadzone(event.caxis.value, config.deadzone_y);
+              right_axis_movement = true;
+            break;
+
+          case SDL_CONTROLLER_AXIS_TRIGGERLEFT:
+            pad.current_l2 = event.caxis.value;
+            break;
+
+          case SDL_CONTROLLER_AXIS_TRIGGERRIGHT:
+            pad.current_r2 = event.caxis.value;
             break;
+        } // switch (event.caxis.axis)
+
+        // fake mouse and scroll wheel, each stick can drive one of them at the same time
+        if (config.left_analog_as_mouse && left_axis_movement) {
+          state.mouseX = pad.current_left_analog_x;
+          state.mouseY = pad.current_left_analog_y;
+        } else if (config.left_analog_as_scroll && left_axis_movement) {
+          state.scrollX = pad.current_left_analog_x;
+          state.scrollY = pad.current_left_analog_y;
+        }
+        if (config.right_analog_as_mouse && right_axis_movement) {
+          state.mouseX = pad.current_right_analog_x;
+          state.mouseY = pad.current_right_analog_y;
+        } else if (config.right_analog_as_scroll && right_axis_movement) {
+          state.scrollX = pad.current_right_analog_x;
+          state.scrollY = pad.current_right_analog_y;
+        }
+
+        // Analogs trigger keys, for the sticks that don't move the mouse or scroll
+        if (!(state.textinputinteractive_mode_active)) {
+          if (left_axis_movement && !config.left_analog_as_mouse && !config.left_analog_as_scroll) {
+            handlePadInput(pad, INPUT_LEFT_ANALOG_UP, pad.current_left_analog_y < 0);
+            handlePadInput(pad, INPUT_LEFT_ANALOG_DOWN, pad.current_left_analog_y > 0);
+            handlePadInput(pad, INPUT_LEFT_ANALOG_LEFT, pad.current_left_analog_x < 0);
+            handlePadInput(pad, INPUT_LEFT_ANALOG_RIGHT, pad.current_left_analog_x > 0);
+          }
+          if (right_axis_movement && !config.right_analog_as_mouse && !config.right_analog_as_scroll) {
+            handlePadInput(pad, INPUT_RIGHT_ANALOG_UP, pad.current_right_analog_y < 0);
+            handlePadInput(pad, INPUT_RIGHT_ANALOG_DOWN, pad.current_right_analog_y > 0);
+            handlePadInput(pad, INPUT_RIGHT_ANALOG_LEFT, pad.current_right_analog_x < 0);
+            handlePadInput(pad, INPUT_RIGHT_ANALOG_RIGHT, pad.current_right_analog_x > 0);
+          }
+        } //!(state.textinputinteractive_mode_active)
+
+        handlePadInput(pad, INPUT_L2, pad.current_l2 > config.deadzone_triggers);
+        handlePadInput(pad, INPUT_R2, pad.current_r2 > config.deadzone_triggers);
+      } // end of else for indicating which axis was moved before checking whether it's assigned as mouse
+    } break;
+    case SDL_CONTROLLERDEVICEADDED:
+      if (!isFakePad(event.cdevice.which)) { // every controller but our own fake pads
+        if (SDL_GameController* controller = SDL_GameControllerOpen(event.cdevice.which)) {
+          pad_slot* pad = padSlot(SDL_JoystickInstanceID(SDL_GameControllerGetJoystick(controller)));
+          if (pad == NULL) {
+            SDL_GameControllerClose(controller);
+          } else {
+            if (pad->controller != NULL) {
+              SDL_GameControllerClose(pad->controller); // opened twice, SDL counts references
+            }
+            pad->controller = controller;
+          }
+        }
+      }
+      break;
+
+    case SDL_CONTROLLERDEVICEREMOVED:
+      releasePadSlot(event.cdevice.which);
+      break;
+
+    case SDL_QUIT:
+      return false;
+      break;
+  }
+
+  return true;
+}
+
+// replay a recorded trace into memory and report throughput, optionally dumping the emitted
+// events as text so the output of two builds can be diffed
+int replayTrace(const char* path)
+{
+  FILE* fp = fopen(path, "rb");
+  if (fp == NULL) {
+    perror("fopen()");
+    return -1;
+  }
+  char magic[8];
+  if ((fread(magic, sizeof(magic), 1, fp) != 1) || (memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0)) {
+    printf("%s is not an input trace\n", path);
+    fclose(fp);
+    return -1;
+  }
+  std::vector<trace_record> records;
+  trace_record record;
+  while (fread(&record, sizeof(record), 1, fp) == 1) {
+    records.push_back(record);
+  }
+  fclose(fp);
+  if (records.empty()) {
+    printf("%s has no events\n", path);
+    return -1;
+  }
+
+  std::vector<struct input_event> emitted;
+  emitted.reserve(records.size() * 8);
+  emit_capture = &emitted;
+
+  const Uint32 first_timestamp = records.front().timestamp;
+  const Uint64 start_ns = monotonicNanos();
+  for (size_t ii = 0; ii < records.size(); ii++) {
+    const trace_record& current = records[ii];
+    const Uint64 record_ns = (Uint64)(current.timestamp - first_timestamp + 1) * 1000000ULL; // never 0, that means "not scheduled"
+
+    // mouse ticks and key repeats that were due before this input
+    for (Uint64 due_ns = nextTimerDeadline(); (due_ns != 0) && (due_ns < record_ns); due_ns = nextTimerDeadline()) {
+      replay_clock_ns = due_ns;
+      runDueTimers(due_ns);
+      flushEmitBatch();
+    }
+    replay_clock_ns = record_ns;
+
+    if (!skip_emit_pauses) {
+      Uint64 due_ns = start_ns + (Uint64)(current.timestamp - first_timestamp) * 1000000ULL;
+      struct timespec due;
+      due.tv_sec = due_ns / 1000000000ULL;
+      due.tv_nsec = due_ns % 1000000000ULL;
+      clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+    }
+
+    SDL_Event event;
+    memset(&event, 0, sizeof(event));
+    event.type = current.type;
+    event.common.timestamp = current.timestamp;
+    if (current.type == SDL_CONTROLLERAXISMOTION) {
+      event.caxis.which = current.which;
+      event.caxis.axis = current.element;
+      event.caxis.value = current.value;
+    } else if ((current.type == SDL_CONTROLLERBUTTONDOWN) || (current.type == SDL_CONTROLLERBUTTONUP)) {
+      event.cbutton.which = current.which;
+      event.cbutton.button = current.element;
+      event.cbutton.state = current.value ? SDL_PRESSED : SDL_RELEASED;
+    } else {
+      event.cdevice.which = current.which;
+    }
+    bool running = handleEvent(event);
+    if (!running || (ii + 1 == records.size()) || (records[ii + 1].timestamp != current.timestamp)) {
+      runDueTimers(record_ns);
+      flushEmitBatch(); // events from the same millisecond came from one poll of SDL, like one event loop wakeup
+    }
+    if (!running) {
+      break;
+    }
+  }
+  while (key_sequence.due_ns != 0) { // text still being typed when the trace ended
+    replay_clock_ns = key_sequence.due_ns;
+    runKeySequence(key_sequence.due_ns);
+    flushEmitBatch();
+  }
+  const Uint64 elapsed_ns = std::max(monotonicNanos() - start_ns, (Uint64)1);
+  emit_capture = NULL;
+
+  size_t emitted_events = 0;
+  for (const auto& ev : emitted) {
+    if (ev.type != EV_SYN) {
+      emitted_events++;
+    }
+  }
+  printf("replayed %zu inputs in %.3f ms (%.0f inputs/s)\n", records.size(), elapsed_ns / 1e6, records.size() * 1e9 / elapsed_ns);
+  printf("emitted %zu events in %zu reports (%.2f events per input)\n", emitted_events, emitted.size() - emitted_events, (double)emitted_events / records.size());
+
+  if (trace_dump_file != NULL) {
+    FILE* dump = fopen(trace_dump_file, "w");
+    if (dump == NULL) {
+      perror("fopen()");
+      return -1;
+    }
+    for (const auto& ev : emitted) {
+      if (ev.type == EV_KEY) {
+        fprintf(dump, "%d %d %d %s\n", ev.type, ev.code, ev.value, keycode_to_name(ev.code));
+      } else {
+        fprintf(dump, "%d %d %d\n", ev.type, ev.code, ev.value);
+      }
+    }
+    fclose(dump);
+  }
+  return 0;
+}
+
+// Native evdev input backend: reads gamepads from /dev/input/event* with libevdev and translates
+// them through the SDL gamecontrollerdb mapping, so handleEvent() gets the same controller events
+// without SDL's joystick thread and event queue in between
+
+#define EVDEV_MAX_PADS 8
+#define EVDEV_MAX_HATS 4
+
+enum evdev_input_type
+{
+  EVDEV_INPUT_NONE,
+  EVDEV_INPUT_BUTTON,
+  EVDEV_INPUT_AXIS,
+  EVDEV_INPUT_HAT
+};
+
+struct evdev_binding // one element of a gamecontrollerdb mapping, e.g. "a:b0", "lefttrigger:a2" or "dpup:h0.1"
+{
+  evdev_input_type input_type = EVDEV_INPUT_NONE;
+  int input_index = 0; // SDL joystick button, axis or hat index
+  int input_hat_mask = 0;
+  int input_min = -32768; // range of the input axis that is used ("+a1" and "-a1" use half of it)
+  int input_max = 32767;
+  bool input_invert = false;
+  bool output_is_axis = false;
+  int output = 0; // SDL_GameControllerButton or SDL_GameControllerAxis
+  int output_min = -32768;
+  int output_max = 32767;
+};
 
-          case SDL_CONTROLLER_BUTTON_START:
-            emitKey(BTN_START, is_pressed);
-            if ((kill_mode) || (textinputpreset_mode) || (textinputinteractive_mode)) {
-              state.start_jsdevice = event.cdevice.which;
-              state.start_pressed = is_pressed;
-            }
-            break;
+struct evdev_pad
+{
+  struct libevdev* device = NULL;
+  int fd = -1;
+  SDL_JoystickID instance_id = 0;
+  char devnode[32];
+  short key_map[KEY_MAX + 1]; // evdev key code to SDL joystick button index
+  short abs_map[ABS_MAX + 1]; // evdev abs code to SDL joystick axis (or hat) index
+  int buttons[KEY_MAX + 1];
+  int axes[ABS_MAX + 1];
+  int hats[EVDEV_MAX_HATS];
+  std::vector<evdev_binding> bindings;
+  int button_output[SDL_CONTROLLER_BUTTON_MAX];
+  int axis_output[SDL_CONTROLLER_AXIS_MAX];
+};
 
-          case SDL_CONTROLLER_BUTTON_DPAD_UP:
-            emitAxisMotion(ABS_HAT0Y, is_pressed ? -1 : 0);
-            break;
+bool evdev_backend = false;
+evdev_pad evdev_pads[EVDEV_MAX_PADS];
+SDL_JoystickID evdev_next_instance_id = 0;
+int evdev_inotify_fd = -1;
+const char* uinput_devnode = NULL; // our own fake device, never read back as input
 
-          case SDL_CONTROLLER_BUTTON_DPAD_DOWN:
-            emitAxisMotion(ABS_HAT0Y, is_pressed ? 1 : 0);
-            break;
+// event loop descriptors are told apart by epoll data.u32: an evdev_pads index, or one of these
+enum loop_source
+{
+  LOOP_SOURCE_TIMER = EVDEV_MAX_PADS,
+  LOOP_SOURCE_HOTPLUG, // inotify on /dev/input
+  LOOP_SOURCE_SDL, // pipe fed by the SDL event thread
+  LOOP_SOURCE_CONFIG, // inotify on the directory of the config file
+  LOOP_SOURCE_APP, // pidfd (or SIGCHLD signalfd) of the launched app
+  LOOP_SOURCE_QUIT // signalfd for SIGTERM and SIGINT
+};
+int loop_epoll_fd = -1;
+int loop_timer_fd = -1;
+int sdl_event_pipe[2] = {-1, -1};
+int quit_signal_fd = -1;
+bool loop_running = true;
 
-          case SDL_CONTROLLER_BUTTON_DPAD_LEFT:
-            emitAxisMotion(ABS_HAT0X, is_pressed ? -1 : 0);
-            break;
+void addLoopSource(int fd, Uint32 source)
+{
+  struct epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.u64 = 0;
+  ev.data.u32 = source;
+  epoll_ctl(loop_epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+}
 
-          case SDL_CONTROLLER_BUTTON_DPAD_RIGHT:
-            emitAxisMotion(ABS_HAT0X, is_pressed ? 1 : 0);
-            break;
-        }
-         if ((kill_mode) && (state.start_pressed && state.hotkey_pressed)) {      
-          if (pckill_mode) {
-            emitKey(KEY_F4,true,KEY_LEFTALT);
-            SDL_Delay(15);
-            emitKey(KEY_F4,false,KEY_LEFTALT);
-          }
-          if (! sudo_kill) {
-             // printf("Killing: %s\n", AppToKill);
-             if (state.start_jsdevice == state.hotkey_jsdevice) {
-                system((" killall  '" + std::string(AppToKill) + "' ").c_str());
-                system("show_splash.sh exit");
-               sleep(3);
-               if (
-                 system((" pgrep '" + std::string(AppToKill) + "' ").c_str()) ==
-                 0) {
-                 printf("Forcefully Killing: %s\n", AppToKill);
-                 system(
-                   (" killall  -9 '" + std::string(AppToKill) + "' ").c_str());
-               }
-            exit(0); 
-            }             
-          } else {
-             if (state.start_jsdevice == state.hotkey_jsdevice) {
-                system((" kill -9 $(pidof '" + std::string(AppToKill) + "') ").c_str());
-               sleep(3);
-               exit(0);
-             }
-           } // sudo kill
-        } //kill mode
-      // xbox360 mode
-      } else { //config mode (i.e. not textinputinteractive_mode_active)
-        switch (event.cbutton.button) {
-          case SDL_CONTROLLER_BUTTON_DPAD_LEFT:
-            if (textinputpreset_mode) { //check if input preset mode is triggered
-                state.textinputpresettrigger_jsdevice = event.cdevice.which;
-                state.textinputpresettrigger_pressed = is_pressed;
-                if (state.start_pressed && state.textinputpresettrigger_pressed) break; //hotkey combo triggered
-            }
-            emitKey(config.left, is_pressed, config.left_modifier);
-            if ((config.left_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.left))) {
-                setKeyRepeat(config.left, is_pressed);
-            }
-            break;
+void stopEventLoop()
+{
+  loop_running = false;
+  if (!evdev_backend) {
+    SDL_Event quit; // lets the SDL event thread return too
+    memset(&quit, 0, sizeof(quit));
+    quit.type = SDL_QUIT;
+    SDL_PushEvent(&quit);
+  }
+}
 
-          case SDL_CONTROLLER_BUTTON_DPAD_UP:
-            emitKey(config.up, is_pressed, config.up_modifier); 
-            if ((config.up_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.up))){
-                setKeyRepeat(config.up, is_pressed);
-            }
-            break;
+const char* evdev_button_names[SDL_CONTROLLER_BUTTON_MAX] = {
+  "a", "b", "x", "y", "back", "guide", "start", "leftstick", "rightstick",
+  "leftshoulder", "rightshoulder", "dpup", "dpdown", "dpleft", "dpright"};
+const char* evdev_axis_names[SDL_CONTROLLER_AXIS_MAX] = {
+  "leftx", "lefty", "rightx", "righty", "lefttrigger", "righttrigger"};
 
-          case SDL_CONTROLLER_BUTTON_DPAD_RIGHT:
-            if (textinputpreset_mode) { //check if input preset enter_press is triggered
-                state.textinputconfirmtrigger_jsdevice = event.cdevice.which;
-                state.textinputconfirmtrigger_pressed = is_pressed;
-                if (state.start_pressed && state.textinputconfirmtrigger_pressed) break; //hotkey combo triggered
-            }
-            emitKey(config.right, is_pressed, config.right_modifier);
-            if ((config.right_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.right))){
-                setKeyRepeat(config.right, is_pressed);
-            }
-            break;
+// SDL joystick GUID for a linux evdev device, as 16 bytes (see SDL_CreateJoystickGUID)
+void evdevPadGUID(const struct libevdev* device, Uint8 guid[16])
+{
+  Uint16 bus = libevdev_get_id_bustype(device);
+  Uint16 vendor = libevdev_get_id_vendor(device);
+  Uint16 product = libevdev_get_id_product(device);
+  Uint16 version = libevdev_get_id_version(device);
+  const char* name = libevdev_get_name(device);
+
+  memset(guid, 0, 16);
+  guid[0] = bus & 0xff;
+  guid[1] = bus >> 8;
+
+  // crc16 of the device name, used by newer SDL versions
+  Uint16 crc = 0;
+  for (const char* ch = name; *ch != '\0'; ch++) {
+    crc ^= (Uint8)*ch;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    }
+  }
+  guid[2] = crc & 0xff;
+  guid[3] = crc >> 8;
+
+  if (vendor && product) {
+    guid[4] = vendor & 0xff;
+    guid[5] = vendor >> 8;
+    guid[8] = product & 0xff;
+    guid[9] = product >> 8;
+    guid[12] = version & 0xff;
+    guid[13] = version >> 8;
+  } else {
+    strncpy((char*)&guid[4], name, 12);
+  }
+}
 
-          case SDL_CONTROLLER_BUTTON_DPAD_DOWN:
-            if (textinputinteractive_mode) {
-                state.textinputinteractivetrigger_jsdevice = event.cdevice.which;
-                state.textinputinteractivetrigger_pressed = is_pressed;
-                if (state.start_pressed && state.textinputinteractivetrigger_pressed) break; //hotkey combo triggered
-            }
-            emitKey(config.down, is_pressed, config.down_modifier);
-            if ((config.down_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.down))){
-                setKeyRepeat(config.down, is_pressed);
-            }
-            break;
+bool parseGUID(const char* str, Uint8 guid[16])
+{
+  for (int ii = 0; ii < 16; ii++) {
+    unsigned int byte;
+    if (sscanf(&str[ii * 2], "%2x", &byte) != 1) {
+      return false;
+    }
+    guid[ii] = byte;
+  }
+  return true;
+}
 
-          case SDL_CONTROLLER_BUTTON_A:
-            if (state.hotkey_pressed) {
-              emitKey(config.a_hk[config.a_hk_current_key], is_pressed, config.a_hk_modifier[config.a_hk_current_key]);
-              if (is_pressed) { //keep track of combo button press so it can be released if hotkey is released before this button is released
-                state.a_hk_was_pressed = true;
-                state.hotkey_combo_triggered = true;
-              } else {
-                state.a_hk_was_pressed = false;
-              }
-            } else if (state.a_hk_was_pressed && !(is_pressed)) {
-              emitKey(config.a_hk[config.a_hk_current_key], is_pressed, config.a_hk_modifier[config.a_hk_current_key]);              
-              state.a_hk_was_pressed = false;
-              if (config.a_hk_cycle) {
-                  config.a_hk_current_key++;
-                  if (config.a_hk_current_key >= config.a_hk_total_keys) {
-                      config.a_hk_current_key = 0;
-                  }
-              } else {
-				  config.a_hk_total_keys = 1;
-			  }
-            } else {
-              emitKey(config.a[config.a_current_key], is_pressed, config.a_modifier[config.a_current_key]);
-              if ((config.a_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.a[config.a_current_key]))){
-                  setKeyRepeat(config.a[config.a_current_key], is_pressed);
-              } else if ((config.a_cycle) && !(is_pressed)) {
-                  config.a_current_key++;
-                  if (config.a_current_key >= config.a_total_keys) {
-                      config.a_current_key = 0;
-                  }
-              } else if (config.a_total_keys < 1) {
-				  config.a_total_keys = 1;
-			  }
+// 2 = exact match, 1 = match ignoring name crc and version (as SDL does), 0 = no match
+int matchGUID(const Uint8 pad_guid[16], const Uint8 mapping_guid[16])
+{
+  if (memcmp(pad_guid, mapping_guid, 16) == 0) {
+    return 2;
+  }
+  for (int ii = 0; ii < 16; ii++) {
+    bool crc_byte = (ii == 2) || (ii == 3);
+    bool version_byte = (ii == 12) || (ii == 13);
+    if ((crc_byte || version_byte) && ((mapping_guid[2 * (ii / 2)] | mapping_guid[2 * (ii / 2) + 1]) == 0)) {
+      continue;
+    }
+    if (crc_byte) {
+      continue;
+    }
+    if (pad_guid[ii] != mapping_guid[ii]) {
+      return 0;
+    }
+  }
+  return 1;
+}
 
-            }
-            break;
+bool parseEvdevBinding(const char* key, const char* value, evdev_binding& binding)
+{
+  // output: button or axis, optionally half axis "+leftx"/"-leftx"
+  if ((key[0] == '+') || (key[0] == '-')) {
+    binding.output_min = (key[0] == '+') ? 0 : -32768;
+    binding.output_max = (key[0] == '+') ? 32767 : 0;
+    key++;
+  }
+  binding.output = -1;
+  for (int ii = 0; ii < SDL_CONTROLLER_BUTTON_MAX; ii++) {
+    if (strcmp(key, evdev_button_names[ii]) == 0) {
+      binding.output = ii;
+    }
+  }
+  for (int ii = 0; ii < SDL_CONTROLLER_AXIS_MAX; ii++) {
+    if (strcmp(key, evdev_axis_names[ii]) == 0) {
+      binding.output = ii;
+      binding.output_is_axis = true;
+      if ((ii == SDL_CONTROLLER_AXIS_TRIGGERLEFT) || (ii == SDL_CONTROLLER_AXIS_TRIGGERRIGHT)) {
+        binding.output_min = 0;
+      }
+    }
+  }
+  if (binding.output < 0) {
+    return false;
+  }
 
-          case SDL_CONTROLLER_BUTTON_B:
-            if (state.hotkey_pressed) {
-              emitKey(config.b_hk[config.b_hk_current_key], is_pressed, config.b_hk_modifier[config.b_hk_current_key]);
-              if (is_pressed) { //keep track of combo button press so it can be released if hotkey is released before this button is released
-                state.b_hk_was_pressed = true;
-                state.hotkey_combo_triggered = true;
-              } else {
-                state.b_hk_was_pressed = false;
-			  }
-            } else if (state.b_hk_was_pressed && !(is_pressed)) {
-              emitKey(config.b_hk[config.b_hk_current_key], is_pressed, config.b_hk_modifier[config.b_hk_current_key]);              
-              state.b_hk_was_pressed = false;
-              if (config.b_hk_cycle) {
-                  config.b_hk_current_key++;
-                  if (config.b_hk_current_key >= config.b_hk_total_keys) {
-                      config.b_hk_current_key = 0;
-                  }
-              } else {
-				config.b_hk_total_keys = 1;
-              }
-            } else {
-              emitKey(config.b[config.b_current_key], is_pressed, config.b_modifier[config.b_current_key]);
-              if ((config.b_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.b[config.b_current_key]))){
-                  setKeyRepeat(config.b[config.b_current_key], is_pressed);
-              } else if ((config.b_cycle) && !(is_pressed)) {
-                  config.b_current_key++;
-                  if (config.b_current_key >= config.b_total_keys) {
-                      config.b_current_key = 0;
-                  }
-              } else if (config.b_total_keys < 1) {
-				  config.b_total_keys = 1;
-			  }
+  // input: "b3", "a1", "+a1", "-a1", "a2~" or "h0.4"
+  if ((value[0] == '+') || (value[0] == '-')) {
+    binding.input_min = (value[0] == '+') ? 0 : -32768;
+    binding.input_max = (value[0] == '+') ? 32767 : 0;
+    value++;
+  }
+  if (value[0] == 'b') {
+    binding.input_type = EVDEV_INPUT_BUTTON;
+    binding.input_index = atoi(&value[1]);
+  } else if (value[0] == 'a') {
+    binding.input_type = EVDEV_INPUT_AXIS;
+    binding.input_index = atoi(&value[1]);
+    binding.input_invert = (strchr(value, '~') != NULL);
+  } else if (value[0] == 'h') {
+    binding.input_type = EVDEV_INPUT_HAT;
+    if (sscanf(&value[1], "%d.%d", &binding.input_index, &binding.input_hat_mask) != 2) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
 
-            }
-            break;
+// find the mapping for this pad in SDL_GAMECONTROLLERCONFIG or SDL_GAMECONTROLLERCONFIG_FILE
+bool loadEvdevMapping(evdev_pad& pad)
+{
+  Uint8 pad_guid[16];
+  evdevPadGUID(pad.device, pad_guid);
 
-          case SDL_CONTROLLER_BUTTON_X:
-            if (state.hotkey_pressed) {
-              emitKey(config.x_hk[config.x_hk_current_key], is_pressed, config.x_hk_modifier[config.x_hk_current_key]);
-              if (is_pressed) { //keep track of combo button press so it can be released if hotkey is released before this button is released
-                state.x_hk_was_pressed = true;
-                state.hotkey_combo_triggered = true;
-              } else {
-                state.x_hk_was_pressed = false;
-              }
-            } else if (state.x_hk_was_pressed && !(is_pressed)) {
-              emitKey(config.x_hk[config.x_hk_current_key], is_pressed, config.x_hk_modifier[config.x_hk_current_key]);              
-              state.x_hk_was_pressed = false;
-              if (config.x_hk_cycle) {
-                  config.x_hk_current_key++;
-                  if (config.x_hk_current_key >= config.x_hk_total_keys) {
-                      config.x_hk_current_key = 0;
-                  }
-              } else {
-				  config.x_hk_total_keys = 1;
-			  }
-            } else {
-              emitKey(config.x[config.x_current_key], is_pressed, config.x_modifier[config.x_current_key]);
-              if ((config.x_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.x[config.x_current_key]))){
-                  setKeyRepeat(config.x[config.x_current_key], is_pressed);
-              } else if ((config.x_cycle) && !(is_pressed)) {
-                  config.x_current_key++;
-                  if (config.x_current_key >= config.x_total_keys) {
-                      config.x_current_key = 0;
-                  }
-              } else if (config.x_total_keys < 1) {
-				  config.x_total_keys = 1;
-			  }
-            }
-            break;
+  std::vector<std::string> lines;
+  if (const char* env_mapping = SDL_getenv("SDL_GAMECONTROLLERCONFIG")) {
+    lines.push_back(env_mapping);
+  }
+  if (const char* db_file = SDL_getenv("SDL_GAMECONTROLLERCONFIG_FILE")) {
+    FILE* fp = fopen(db_file, "r");
+    if (fp == NULL) {
+      perror("fopen()");
+    } else {
+      char line[1024];
+      while (fgets(line, sizeof(line), fp) != NULL) {
+        if ((line[0] != '#') && (strlen(line) > 32)) {
+          lines.push_back(line);
+        }
+      }
+      fclose(fp);
+    }
+  }
 
-          case SDL_CONTROLLER_BUTTON_Y:
-            if (state.hotkey_pressed) {
-              emitKey(config.y_hk[config.y_hk_current_key], is_pressed, config.y_hk_modifier[config.y_hk_current_key]);
-              if (is_pressed) { //keep track of combo button press so it can be released if hotkey is released before this button is released
-                state.y_hk_was_pressed = true;
-                state.hotkey_combo_triggered = true;
-              } else {
-                state.y_hk_was_pressed = false;
-              }
-            } else if (state.y_hk_was_pressed && !(is_pressed)) {
-              emitKey(config.y_hk[config.y_hk_current_key], is_pressed, config.y_hk_modifier[config.y_hk_current_key]);              
-              state.y_hk_was_pressed = false;
-              if (config.y_hk_cycle) {
-                  config.y_hk_current_key++;
-                  if (config.y_hk_current_key >= config.y_hk_total_keys) {
-                      config.y_hk_current_key = 0;
-                  }
-              } else {
-				  config.y_hk_total_keys = 1;
-			  }
-            } else {
-              emitKey(config.y[config.y_current_key], is_pressed, config.y_modifier[config.y_current_key]);
-              if ((config.y_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.y[config.y_current_key]))){
-                  setKeyRepeat(config.y[config.y_current_key], is_pressed);
-              } else if ((config.y_cycle) && !(is_pressed)) {
-                  config.y_current_key++;
-                  if (config.y_current_key >= config.y_total_keys) {
-                      config.y_current_key = 0;
-                  }
-              } else if (config.y_total_keys < 1) {
-				  config.y_total_keys = 1;
-			  }
-            }
-            break;
+  int best_match = 0;
+  std::string best_line;
+  for (const auto& line : lines) {
+    Uint8 mapping_guid[16];
+    if (!parseGUID(line.c_str(), mapping_guid)) {
+      continue;
+    }
+    if ((line.find("platform:") != std::string::npos) && (line.find("platform:Linux") == std::string::npos)) {
+      continue;
+    }
+    int match = matchGUID(pad_guid, mapping_guid);
+    if (match > best_match) {
+      best_match = match;
+      best_line = line;
+    }
+  }
+  if (best_match == 0) {
+    return false;
+  }
 
-          case SDL_CONTROLLER_BUTTON_LEFTSHOULDER:
-            if (state.hotkey_pressed) {
-              emitKey(config.l1_hk[config.l1_hk_current_key], is_pressed, config.l1_hk_modifier[config.l1_hk_current_key]);
-              if (is_pressed) { //keep track of combo button press so it can be released if hotkey is released before this button is released
-                state.l1_hk_was_pressed = true;
-                state.hotkey_combo_triggered = true;
-              } else {
-                state.l1_hk_was_pressed = false;
-              }
-            } else if (state.l1_hk_was_pressed && !(is_pressed)) {
-              emitKey(config.l1_hk[config.l1_hk_current_key], is_pressed, config.l1_hk_modifier[config.l1_hk_current_key]);              
-              state.l1_hk_was_pressed = false;
-              if (config.l1_hk_cycle) {
-                  config.l1_hk_current_key++;
-                  if (config.l1_hk_current_key >= config.l1_hk_total_keys) {
-                      config.l1_hk_current_key = 0;
-                  }
-              } else {
-				  config.l1_hk_total_keys = 1;
-			  }
-            } else {
-              emitKey(config.l1[config.l1_current_key], is_pressed, config.l1_modifier[config.l1_current_key]);
-              if ((config.l1_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.l1[config.l1_current_key]))){
-                  setKeyRepeat(config.l1[config.l1_current_key], is_pressed);
-              } else if ((config.l1_cycle) && !(is_pressed)) {
-                  config.l1_current_key++;
-                  if (config.l1_current_key >= config.l1_total_keys) {
-                      config.l1_current_key = 0;
-                  }
-              } else if (config.l1_total_keys < 1) {
-				  config.l1_total_keys = 1;
-			  }
+  // skip guid and name, then read "key:value" elements
+  std::stringstream elements(best_line);
+  std::string element;
+  std::getline(elements, element, ',');
+  std::getline(elements, element, ',');
+  printf("evdev: %s uses mapping for %s\n", pad.devnode, element.c_str());
+  pad.bindings.clear();
+  while (std::getline(elements, element, ',')) {
+    size_t colon = element.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    evdev_binding binding;
+    if (parseEvdevBinding(element.substr(0, colon).c_str(), element.substr(colon + 1).c_str(), binding)) {
+      pad.bindings.push_back(binding);
+    }
+  }
+  return !pad.bindings.empty();
+}
 
-            }
-            break;
+// number buttons, axes and hats in the same order SDL's linux joystick driver does
+void mapEvdevPadElements(evdev_pad& pad)
+{
+  int buttons = 0;
+  int axes = 0;
+  int hats = 0;
+
+  memset(pad.key_map, 0xff, sizeof(pad.key_map));
+  memset(pad.abs_map, 0xff, sizeof(pad.abs_map));
+  for (int code = BTN_JOYSTICK; code < KEY_MAX; code++) {
+    if (libevdev_has_event_code(pad.device, EV_KEY, code)) {
+      pad.key_map[code] = buttons++;
+    }
+  }
+  for (int code = 0; code < BTN_JOYSTICK; code++) {
+    if (libevdev_has_event_code(pad.device, EV_KEY, code)) {
+      pad.key_map[code] = buttons++;
+    }
+  }
+  for (int code = 0; code < ABS_MAX; code++) {
+    if (code == ABS_HAT0X) { // hats are counted separately
+      code = ABS_HAT3Y;
+      continue;
+    }
+    if (libevdev_has_event_code(pad.device, EV_ABS, code)) {
+      pad.abs_map[code] = axes++;
+    }
+  }
+  for (int code = ABS_HAT0X; code <= ABS_HAT3Y; code += 2) {
+    if (libevdev_has_event_code(pad.device, EV_ABS, code) || libevdev_has_event_code(pad.device, EV_ABS, code + 1)) {
+      pad.abs_map[code] = hats;
+      pad.abs_map[code + 1] = hats;
+      hats++;
+    }
+  }
 
-          case SDL_CONTROLLER_BUTTON_RIGHTSHOULDER:
-            if (state.hotkey_pressed) {
-              emitKey(config.r1_hk[config.r1_hk_current_key], is_pressed, config.r1_hk_modifier[config.r1_hk_current_key]);
-              if (is_pressed) { //keep track of combo button press so it can be released if hotkey is released before this button is released
-                state.r1_hk_was_pressed = true;
-                state.hotkey_combo_triggered = true;
-              } else {
-                state.r1_hk_was_pressed = false;
-              }
-            } else if (state.r1_hk_was_pressed && !(is_pressed)) {
-              emitKey(config.r1_hk[config.r1_hk_current_key], is_pressed, config.r1_hk_modifier[config.r1_hk_current_key]);              
-              state.r1_hk_was_pressed = false;
-              if (config.r1_hk_cycle) {
-                  config.r1_hk_current_key++;
-                  if (config.r1_hk_current_key >= config.r1_hk_total_keys) {
-                      config.r1_hk_current_key = 0;
-                  }
-              } else {
-				  config.r1_hk_total_keys = 1;
-			  }
-            } else {
-              emitKey(config.r1[config.r1_current_key], is_pressed, config.r1_modifier[config.r1_current_key]);
-              if ((config.r1_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.r1[config.r1_current_key]))){
-                  setKeyRepeat(config.r1[config.r1_current_key], is_pressed);
-              } else if ((config.r1_cycle) && !(is_pressed)) {
-                  config.r1_current_key++;
-                  if (config.r1_current_key >= config.r1_total_keys) {
-                      config.r1_current_key = 0;
-                  }
-              } else if (config.r1_total_keys < 1) {
-				  config.r1_total_keys = 1;
-			  }
-            }
-            break;
+  memset(pad.buttons, 0, sizeof(pad.buttons));
+  memset(pad.axes, 0, sizeof(pad.axes));
+  memset(pad.hats, 0, sizeof(pad.hats));
+  for (int ii = 0; ii < SDL_CONTROLLER_BUTTON_MAX; ii++) {
+    pad.button_output[ii] = 0;
+  }
+  for (int ii = 0; ii < SDL_CONTROLLER_AXIS_MAX; ii++) {
+    pad.axis_output[ii] = 0;
+  }
+}
 
-          case SDL_CONTROLLER_BUTTON_LEFTSTICK:
-            if ((kill_mode && hotkey_override && (strcmp(hotkey_code, "l3") == 0)) || (textinputpreset_mode && hotkey_override && (strcmp(hotkey_code, "l3") == 0)) || (textinputinteractive_mode && hotkey_override && (strcmp(hotkey_code, "l3") == 0))) {
-                state.hotkey_jsdevice = event.cdevice.which;
-                state.hotkey_pressed = is_pressed;
-            } else if (hotkey_override && (strcmp(hotkey_code, "l3") == 0)) {
-                state.hotkey_jsdevice = event.cdevice.which;
-                state.hotkey_pressed = is_pressed;            
-            }
-            if (state.hotkey_pressed && (state.hotkey_jsdevice == event.cdevice.which)) {
-              state.hotkey_was_pressed = true; // if hotkey is pressed, note the details of hotkey press in case it is released without triggering a hotkey combo event, since its press will need to be processed
-              
-            } else if (state.hotkey_combo_triggered && !(is_pressed)) { 
-              state.hotkey_combo_triggered = false; //hotkey combo was pressed; ignore hotkey button release
-              state.hotkey_was_pressed = false; //reset hotkey
-            } else if (state.hotkey_was_pressed && !(is_pressed)) { 
-              state.hotkey_was_pressed = false;
-              emitKey(config.l3, true, config.l3_modifier); //key pressed and now released without hotkey trigger so process key press then key release
-              SDL_Delay(16);
-              emitKey(config.l3, is_pressed, config.l3_modifier);            
-              if ((config.l3_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.l3))){
-                setKeyRepeat(config.l3, is_pressed);
-                //note: hotkey cannot be assigned for key repeat; release key repeat for completeness
-              }
-            } //hotkey state check prior to emitting key, to avoid conflicts with emitkey and hotkey press        
-              else {
-              emitKey(config.l3, is_pressed, config.l3_modifier);            
-              if ((config.l3_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.l3))){
-                setKeyRepeat(config.l3, is_pressed);
-              }
-            }
-            break;
+// scale a raw evdev axis value to SDL's -32768..32767 range
+int normaliseEvdevAxis(const evdev_pad& pad, int code, int value)
+{
+  const struct input_absinfo* info = libevdev_get_abs_info(pad.device, code);
+  if ((info == NULL) || (info->maximum <= info->minimum)) {
+    return value;
+  }
+  long scaled = (long)(value - info->minimum) * 65535L / (info->maximum - info->minimum) - 32768L;
+  return std::max(-32768L, std::min(32767L, scaled));
+}
 
-          case SDL_CONTROLLER_BUTTON_RIGHTSTICK:
-            emitKey(config.r3, is_pressed, config.r3_modifier);
-            if ((config.r3_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.r3))){
-                setKeyRepeat(config.r3, is_pressed);
-            }
-            break;
+void dispatchEvdevPadEvent(evdev_pad& pad, const evdev_binding& binding, int value)
+{
+  SDL_Event event;
+  memset(&event, 0, sizeof(event));
 
-          case SDL_CONTROLLER_BUTTON_GUIDE:
-            if ((kill_mode && !(hotkey_override)) || (kill_mode && hotkey_override && (strcmp(hotkey_code, "guide") == 0)) || (textinputpreset_mode && !(hotkey_override)) || (textinputpreset_mode && (strcmp(hotkey_code, "guide") == 0)) || (textinputinteractive_mode && !(hotkey_override)) || (textinputinteractive_mode && (strcmp(hotkey_code, "guide") == 0))) {
-              state.hotkey_jsdevice = event.cdevice.which;
-              state.hotkey_pressed = is_pressed;
-            } else if (!(hotkey_override)) {
-              state.hotkey_jsdevice = event.cdevice.which;
-              state.hotkey_pressed = is_pressed;
-            }
-            if (state.hotkey_pressed && (state.hotkey_jsdevice == event.cdevice.which)) {
-              state.hotkey_was_pressed = true; // if hotkey is pressed, note the details of hotkey press in case it is released without triggering a hotkey combo event, since its press will need to be processed
-              
-            } else if (state.hotkey_combo_triggered && !(is_pressed)) { 
-              state.hotkey_combo_triggered = false; //hotkey combo was pressed; ignore hotkey button release
-              state.hotkey_was_pressed = false; //reset hotkey
-              
-            } else if (state.hotkey_was_pressed && !(is_pressed)) { 
-              state.hotkey_was_pressed = false;
-              emitKey(config.guide, true, config.guide_modifier); //key pressed and now released without hotkey trigger so process key press then key release
-              SDL_Delay(16);
-              emitKey(config.guide, is_pressed, config.guide_modifier);
-              if ((config.guide_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.guide))){
-                setKeyRepeat(config.guide, is_pressed);
-                //note: hotkey cannot be assigned for key repeat; release key repeat for completeness
-              }
-            } //hotkey state check prior to emitting key, to avoid conflicts with emitkey and hotkey press        
-              else {
-              emitKey(config.guide, is_pressed, config.guide_modifier);
-              if ((config.guide_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.guide))){
-                setKeyRepeat(config.guide, is_pressed);
-              }
-            }
-            break;
+  if (binding.output_is_axis) {
+    if (pad.axis_output[binding.output] == value) {
+      return;
+    }
+    pad.axis_output[binding.output] = value;
+    event.type = SDL_CONTROLLERAXISMOTION;
+    event.caxis.which = pad.instance_id;
+    event.caxis.axis = binding.output;
+    event.caxis.value = value;
+  } else {
+    if (pad.button_output[binding.output] == value) {
+      return;
+    }
+    pad.button_output[binding.output] = value;
+    event.type = value ? SDL_CONTROLLERBUTTONDOWN : SDL_CONTROLLERBUTTONUP;
+    event.cbutton.which = pad.instance_id;
+    event.cbutton.button = binding.output;
+    event.cbutton.state = value ? SDL_PRESSED : SDL_RELEASED;
+  }
+  event.common.timestamp = SDL_GetTicks();
+  if (!handleEvent(event)) {
+    stopEventLoop();
+  }
+}
 
-          case SDL_CONTROLLER_BUTTON_BACK: // aka select
-            if (!emuelec_override) {
-            if ((kill_mode && !(hotkey_override)) || (kill_mode && hotkey_override && (strcmp(hotkey_code, "back") == 0))) {
-              state.hotkey_jsdevice = event.cdevice.which;
-              state.hotkey_pressed = is_pressed;
-            } else if (!(hotkey_override)) {
-              state.hotkey_jsdevice = event.cdevice.which;
-              state.hotkey_pressed = is_pressed;
-            }
-            }
-            
-            if (state.hotkey_pressed && (state.hotkey_jsdevice == event.cdevice.which)) {
-              state.hotkey_was_pressed = true; // if hotkey is pressed, note the details of hotkey press in case it is released without triggering a hotkey combo event, since its press will need to be processed
-              
-            } else if (state.hotkey_combo_triggered && !(is_pressed)) { 
-              state.hotkey_combo_triggered = false; //hotkey combo was pressed; ignore hotkey button release
-              state.hotkey_was_pressed = false; //reset hotkey
-              
-            } else if (state.hotkey_was_pressed && !(is_pressed)) { 
-              state.hotkey_was_pressed = false;
-              emitKey(config.back, true, config.back_modifier); //key pressed and now released without hotkey trigger so process key press then key release
-              SDL_Delay(16);
-              emitKey(config.back, is_pressed, config.back_modifier);
-              if ((config.back_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.back))){
-                setKeyRepeat(config.back, is_pressed);
-                //note: hotkey cannot be assigned for key repeat; release key repeat for completeness
-              }
-            } //hotkey state check prior to emitting key, to avoid conflicts with emitkey and hotkey press        
-            else {
-              emitKey(config.back, is_pressed, config.back_modifier);
-              if ((config.back_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.back))){
-                setKeyRepeat(config.back, is_pressed);
-              }
-            }
-            break;
+// re-evaluate every binding that reads the input element that just changed
+void updateEvdevPadOutputs(evdev_pad& pad, evdev_input_type input_type, int input_index)
+{
+  for (const auto& binding : pad.bindings) {
+    if ((binding.input_type != input_type) || (binding.input_index != input_index)) {
+      continue;
+    }
 
-          case SDL_CONTROLLER_BUTTON_START:
-            if ((kill_mode) || (textinputpreset_mode) || (textinputinteractive_mode)) {
-                state.start_jsdevice = event.cdevice.which;
-                state.start_pressed = is_pressed;
-            } // start pressed - ready for text input modes if trigger is also pressed
-            if (state.start_pressed && (state.start_jsdevice == event.cdevice.which)) { 
-              state.start_was_pressed = true; // if start as hotkey is pressed, note the details of start key press in case it is released without triggering a hotkey event, since its press will need to be processed
-              
-            } else if (state.start_combo_triggered && !(is_pressed)) { 
-              state.start_combo_triggered = false; //ignore start key release if it acted as hotkey
-              state.start_was_pressed = false; //reset hotkey
-              
-            } else if (state.start_was_pressed && !(is_pressed)) { //key pressed and now released without start trigger so process original key press, pause, then process key release
-              state.start_was_pressed = false;
-              emitKey(config.start, true, config.start_modifier);
-              SDL_Delay(16);
-              emitKey(config.start, is_pressed, config.start_modifier);
-              //note: start cannot be assigned for key repeat; release key repeat for completeness
-              if ((config.start_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.start))){
-                setKeyRepeat(config.start, is_pressed);
-              }
-            } else { //process start key as normal
-              emitKey(config.start, is_pressed, config.start_modifier);
-              if ((config.start_repeat && is_pressed && (state.key_to_repeat == 0)) || (!(is_pressed) && (state.key_to_repeat == config.start))){
-                setKeyRepeat(config.start, is_pressed);
-              }
-            }
-            break;
-        } //switch
-        if ((kill_mode) && (state.start_pressed && state.hotkey_pressed)) {
-          if (pckill_mode) {
-            emitKey(KEY_F4,true,KEY_LEFTALT);
-            SDL_Delay(15);
-            emitKey(KEY_F4,false,KEY_LEFTALT);
-          }
-          SDL_RemoveTimer( state.key_repeat_timer_id );
-          if (! sudo_kill) {
-             // printf("Killing: %s\n", AppToKill);
-             if (state.start_jsdevice == state.hotkey_jsdevice) {
-                system((" killall  '" + std::string(AppToKill) + "' ").c_str());
-                system("show_splash.sh exit");
-               sleep(3);
-               if (
-                 system((" pgrep '" + std::string(AppToKill) + "' ").c_str()) ==
-                 0) {
-                 printf("Forcefully Killing: %s\n", AppToKill);
-                 system(
-                   (" killall  -9 '" + std::string(AppToKill) + "' ").c_str());
-               }
-            exit(0); 
-            }   
-          } else {
-             if (state.start_jsdevice == state.hotkey_jsdevice) {
-                system((" kill -9 $(pidof '" + std::string(AppToKill) + "') ").c_str());
-               sleep(3);
-               exit(0);
-             }
-           } // sudo kill
-        } //kill mode 
-        else if ((textinputpreset_mode) && (state.textinputpresettrigger_pressed && state.start_pressed)) { //activate input preset mode - send predefined text as a series of keystrokes
-            printf("text input preset pressed\n");
-            state.start_combo_triggered = true;
-            if (state.start_jsdevice == state.textinputpresettrigger_jsdevice) {
-                if (config.text_input_preset != NULL) {
-                    printf("text input processing %s\n", config.text_input_preset);
-                    processKeys();
-                }
-            }
-            state.textinputpresettrigger_pressed = false; //reset textinputpreset trigger
-            state.start_pressed = false;
-            state.start_jsdevice = 0;
-            state.textinputpresettrigger_jsdevice = 0;
-         } //input preset trigger mode (i.e. not kill mode)
-        else if ((textinputpreset_mode) && (state.textinputconfirmtrigger_pressed && state.start_pressed)) { //activate input preset confirm mode - send ENTER key
-            printf("text input confirm pressed\n");
-            state.start_combo_triggered = true;
-            if (state.start_jsdevice == state.textinputconfirmtrigger_jsdevice) {
-                printf("text input Enter key\n");
-                emitKey(char_to_keycode("enter"), true);
-                SDL_Delay(15);
-                emitKey(char_to_keycode("enter"), false);
-            }
-            state.textinputconfirmtrigger_pressed = false; //reset textinputpreset confirm trigger
-            state.start_pressed = false;
-            state.start_jsdevice = 0;
-            state.textinputconfirmtrigger_jsdevice = 0;
-          } //input confirm trigger mode (i.e. not kill mode)         
-        else if ((textinputinteractive_mode) && (state.textinputinteractivetrigger_pressed && state.start_pressed)) { //activate interactive text input mode
-            printf("text input interactive pressed\n");
-            state.start_combo_triggered = true;
-            if (state.start_jsdevice == state.textinputinteractivetrigger_jsdevice) {
-                printf("text input interactive mode active\n");
-                state.textinputinteractive_mode_active = true;
-                SDL_RemoveTimer( state.key_repeat_timer_id ); // disable any active key repeat timer
-                current_character = 0;
+    // input as fraction of its range, 0..1
+    float input;
+    if (input_type == EVDEV_INPUT_BUTTON) {
+      input = pad.buttons[input_index] ? 1.0f : 0.0f;
+    } else if (input_type == EVDEV_INPUT_HAT) {
+      input = (pad.hats[input_index] & binding.input_hat_mask) ? 1.0f : 0.0f;
+    } else {
+      int value = pad.axes[input_index];
+      if (binding.input_invert) {
+        value = -1 - value;
+      }
+      value = std::max(binding.input_min, std::min(binding.input_max, value));
+      input = (float)(value - binding.input_min) / (binding.input_max - binding.input_min);
+      if (binding.input_max == 0) { // "-a1" reads towards the negative end
+        input = 1.0f - input;
+      }
+    }
+
+    if (binding.output_is_axis) {
+      int value;
+      if ((input_type == EVDEV_INPUT_AXIS) && (binding.input_min < 0) && (binding.input_max > 0)) {
+        value = binding.output_min + (int)(input * (binding.output_max - binding.output_min));
+      } else if (binding.output_max == 0) {
+        value = (int)(input * binding.output_min);
+      } else {
+        value = (int)(input * binding.output_max);
+      }
+      dispatchEvdevPadEvent(pad, binding, value);
+    } else {
+      dispatchEvdevPadEvent(pad, binding, input >= 0.5f ? 1 : 0);
+    }
+  }
+}
+
+void handleEvdevPadEvent(evdev_pad& pad, const struct input_event& ev)
+{
+  evdev_input_time_ns = ev.time.tv_sec * 1000000000ULL + ev.time.tv_usec * 1000ULL;
+  if ((ev.type == EV_KEY) && (ev.code <= KEY_MAX) && (pad.key_map[ev.code] >= 0)) {
+    int button = pad.key_map[ev.code];
+    pad.buttons[button] = (ev.value != 0);
+    updateEvdevPadOutputs(pad, EVDEV_INPUT_BUTTON, button);
+  } else if ((ev.type == EV_ABS) && (ev.code <= ABS_MAX) && (pad.abs_map[ev.code] >= 0)) {
+    if ((ev.code >= ABS_HAT0X) && (ev.code <= ABS_HAT3Y)) {
+      int hat = pad.abs_map[ev.code];
+      bool is_x = ((ev.code - ABS_HAT0X) % 2) == 0;
+      int low_bit = is_x ? 8 : 1; // SDL_HAT_LEFT or SDL_HAT_UP
+      int high_bit = is_x ? 2 : 4; // SDL_HAT_RIGHT or SDL_HAT_DOWN
+      pad.hats[hat] &= ~(low_bit | high_bit);
+      if (ev.value < 0) {
+        pad.hats[hat] |= low_bit;
+      } else if (ev.value > 0) {
+        pad.hats[hat] |= high_bit;
+      }
+      updateEvdevPadOutputs(pad, EVDEV_INPUT_HAT, hat);
+    } else {
+      int axis = pad.abs_map[ev.code];
+      pad.axes[axis] = normaliseEvdevAxis(pad, ev.code, ev.value);
+      updateEvdevPadOutputs(pad, EVDEV_INPUT_AXIS, axis);
+    }
+  }
+}
+
+void closeEvdevPad(evdev_pad& pad)
+{
+  printf("evdev: %s removed\n", pad.devnode);
+  releasePadSlot(pad.instance_id);
+  epoll_ctl(loop_epoll_fd, EPOLL_CTL_DEL, pad.fd, NULL);
+  libevdev_free(pad.device);
+  close(pad.fd);
+  pad.device = NULL;
+  pad.fd = -1;
+}
+
+void openEvdevPad(const char* devnode)
+{
+  if ((uinput_devnode != NULL) && (strcmp(devnode, uinput_devnode) == 0)) {
+    return;
+  }
+  int free_slot = -1;
+  for (int ii = 0; ii < EVDEV_MAX_PADS; ii++) {
+    if ((evdev_pads[ii].device != NULL) && (strcmp(evdev_pads[ii].devnode, devnode) == 0)) {
+      return; // already open
+    } else if ((evdev_pads[ii].device == NULL) && (free_slot < 0)) {
+      free_slot = ii;
+    }
+  }
+  if (free_slot < 0) {
+    return;
+  }
+
+  int fd = open(devnode, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+  evdev_pad& pad = evdev_pads[free_slot];
+  if (libevdev_new_from_fd(fd, &pad.device) < 0) {
+    close(fd);
+    pad.device = NULL;
+    return;
+  }
+  strncpy(pad.devnode, devnode, sizeof(pad.devnode) - 1);
+  pad.devnode[sizeof(pad.devnode) - 1] = '\0';
+
+  bool is_fake_device = (strcmp(libevdev_get_name(pad.device), "Fake Keyboard") == 0) ||
+    ((strcmp(libevdev_get_name(pad.device), "Microsoft X-Box 360 pad") == 0) &&
+     (libevdev_get_phys(pad.device) == NULL));
+  if (is_fake_device || !libevdev_has_event_type(pad.device, EV_KEY) || !loadEvdevMapping(pad)) {
+    libevdev_free(pad.device);
+    close(fd);
+    pad.device = NULL;
+    return;
+  }
 
-                addTextInputCharacter();
-            }
-            state.textinputinteractivetrigger_pressed = false; //reset interactive text input mode trigger
-            state.start_pressed = false;
-            state.textinputinteractivetrigger_jsdevice = 0;
-            state.start_jsdevice = 0;
-          } //input interactive trigger mode (i.e. not kill mode)
-      }  //xbox or config/default
-    } break; // case SDL_CONTROLLERBUTTONUP: SDL_CONTROLLERBUTTONDOWN:
+  pad.fd = fd;
+  pad.instance_id = evdev_next_instance_id++;
+  int clock_id = CLOCK_MONOTONIC; // event timestamps on the same clock as the latency histograms
+  ioctl(fd, EVIOCSCLOCKID, &clock_id);
+  mapEvdevPadElements(pad);
 
-    case SDL_CONTROLLERAXISMOTION:
-      if (xbox360_mode) {
-        switch (event.caxis.axis) {
-          case SDL_CONTROLLER_AXIS_LEFTX:
-            emitAxisMotion(ABS_X, event.caxis.value);
-            break; 
+  addLoopSource(fd, free_slot);
+  printf("evdev: opened %s (%s) as controller %d\n", devnode, libevdev_get_name(pad.device), pad.instance_id);
+}
 
-          case SDL_CONTROLLER_AXIS_LEFTY:
-            emitAxisMotion(ABS_Y, event.caxis.value);
-            break;
+void scanEvdevPads()
+{
+  DIR* dir = opendir("/dev/input");
+  if (dir == NULL) {
+    perror("opendir()");
+    return;
+  }
+  while (struct dirent* entry = readdir(dir)) {
+    if (strncmp(entry->d_name, "event", 5) == 0) {
+      openEvdevPad((std::string("/dev/input/") + entry->d_name).c_str());
+    }
+  }
+  closedir(dir);
+}
 
-          case SDL_CONTROLLER_AXIS_RIGHTX:
-            emitAxisMotion(ABS_RX, event.caxis.value);
-            break;
+void readEvdevPad(evdev_pad& pad)
+{
+  struct input_event ev;
+  int rc;
+  do {
+    rc = libevdev_next_event(pad.device, LIBEVDEV_READ_FLAG_NORMAL, &ev);
+    if (rc == LIBEVDEV_READ_STATUS_SYNC) { // events were dropped, catch up with the device state
+      while (rc == LIBEVDEV_READ_STATUS_SYNC) {
+        handleEvdevPadEvent(pad, ev);
+        rc = libevdev_next_event(pad.device, LIBEVDEV_READ_FLAG_SYNC, &ev);
+      }
+    } else if (rc == LIBEVDEV_READ_STATUS_SUCCESS) {
+      handleEvdevPadEvent(pad, ev);
+    }
+  } while ((rc == LIBEVDEV_READ_STATUS_SUCCESS) || (rc == LIBEVDEV_READ_STATUS_SYNC));
 
-          case SDL_CONTROLLER_AXIS_RIGHTY:
-            emitAxisMotion(ABS_RY, event.caxis.value);
-            break;
+  if (rc == -ENODEV) {
+    closeEvdevPad(pad);
+  }
+}
 
-          case SDL_CONTROLLER_AXIS_TRIGGERLEFT:
-            // The target range for the triggers is 0..255 instead of
-            // 0..32767, so we shift down by 7 as that does exactly the
-            // scaling we need (32767 >> 7 is 255)
-            emitAxisMotion(ABS_Z, event.caxis.value >> 7);
-            break;
+// Event loop: one thread sleeps in epoll_wait() until input arrives or the timerfd reaches the
+// next mouse tick or key repeat, so buttons are never held back by mouse movement and an idle
+// process does not wake up at all
 
-          case SDL_CONTROLLER_AXIS_TRIGGERRIGHT:
-            emitAxisMotion(ABS_RZ, event.caxis.value >> 7);
-            break;
-        }
-      } else {
-        // indicate which axis was moved before checking whether it's assigned as mouse
-        bool left_axis_movement = false;
-        bool right_axis_movement = false;
-        
-        switch (event.caxis.axis) {
-          case SDL_CONTROLLER_AXIS_LEFTX:
-            state.current_left_analog_x =
-              applyDeadzone(event.caxis.value, config.deadzone_x);
-              left_axis_movement = true;
-            break;
+// config hot reload; the directory is watched because editors often save by renaming a new file over the old one
+const char* config_file_path = NULL; // config loaded at startup, reloaded when it changes
+std::string config_watch_name; // its name in the watched directory
+int config_inotify_fd = -1;
 
-          case SDL_CONTROLLER_AXIS_LEFTY:
-            state.current_left_analog_y =
-              applyDeadzone(event.caxis.value, config.deadzone_y);
-              left_axis_movement = true;
-            break;
+void watchConfigFile()
+{
+  char real_path[PATH_MAX];
+  if (realpath(config_file_path, real_path) == NULL) {
+    return;
+  }
+  char* slash = strrchr(real_path, '/');
+  config_watch_name = slash + 1;
+  *slash = '\0';
+  config_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if ((config_inotify_fd < 0) || (inotify_add_watch(config_inotify_fd, (slash == real_path) ? "/" : real_path, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)) {
+    perror("inotify_add_watch()");
+    return;
+  }
+  addLoopSource(config_inotify_fd, LOOP_SOURCE_CONFIG);
+}
 
-          case SDL_CONTROLLER_AXIS_RIGHTX:
-            state.current_right_analog_x =
-              applyDeadzone(event.caxis.value, config.deadzone_x);
-              right_axis_movement = true;
-            break;
+// the fake device can't gain codes after creation, tell which ones the new mapping can't send
+void reportUndeclaredCodes()
+{
+  if (uinput_description == NULL) {
+    return;
+  }
+  struct libevdev* wanted = libevdev_new();
+  setupFakeKeyboardMouseDevice(wanted);
+  for (int code = 0; code < KEY_CNT; code++) {
+    if (libevdev_has_event_code(wanted, EV_KEY, code) && !libevdev_has_event_code(uinput_description, EV_KEY, code)) {
+      printf("key %s needs a restart of gptokeyb to be sent\n", keycode_to_name(code));
+    }
+  }
+  if (libevdev_has_event_code(wanted, EV_REL, REL_X) && !libevdev_has_event_code(uinput_description, EV_REL, REL_X)) {
+    printf("mouse movement needs a restart of gptokeyb to be sent\n");
+  }
+  if (libevdev_has_event_code(wanted, EV_REL, REL_WHEEL) && !libevdev_has_event_code(uinput_description, EV_REL, REL_WHEEL)) {
+    printf("scroll wheel needs a restart of gptokeyb to be sent\n");
+  }
+  libevdev_free(wanted);
+}
 
-          case SDL_CONTROLLER_AXIS_RIGHTY:
-            state.current_right_analog_y =
-              applyDeadzone(event.caxis.value, config.deadzone_y);
-              right_axis_movement = true;
-            break;
+// a changed config always misses the cache, so its image is hashed, written and renamed by a thread of
+// its own; the one written for the previous reload is waited for first, which is normally long done
+SDL_Thread* config_cache_writer = NULL;
 
-          case SDL_CONTROLLER_AXIS_TRIGGERLEFT:
-            state.current_l2 = event.caxis.value;
-            break;
+int writeReloadedConfigCache(void* data)
+{
+  config_cache_image* image = (config_cache_image*)data;
+  char source_path[PATH_MAX];
+  struct stat source;
+  Uint64 source_hash;
+  // hashed after parsing, so a file that changed since it was parsed doesn't get an image
+  if ((realpath(config_file_path, source_path) != NULL) && hashFile(source_path, source_hash) && (stat(source_path, &source) == 0)
+    && (mtimeNanos(source) == image->source_mtime_ns) && ((Sint64)source.st_size == image->source_size)) {
+    std::string cache_path = configCachePath(source_path);
+    if (!cache_path.empty()) {
+      snprintf(image->source_path, sizeof(image->source_path), "%s", source_path);
+      image->source_hash = source_hash;
+      storeConfigCache(cache_path, image);
+    }
+  }
+  delete image;
+  return 0;
+}
 
-          case SDL_CONTROLLER_AXIS_TRIGGERRIGHT:
-            state.current_r2 = event.caxis.value;
-            break;
-        } // switch (event.caxis.axis)
+void waitConfigCacheWriter()
+{
+  if (config_cache_writer != NULL) {
+    SDL_WaitThread(config_cache_writer, NULL);
+    config_cache_writer = NULL;
+  }
+}
 
-        // fake mouse
-        if (config.left_analog_as_mouse && left_axis_movement) {
-          state.mouseX = state.current_left_analog_x / config.fake_mouse_scale;
-          state.mouseY = state.current_left_analog_y / config.fake_mouse_scale;
-        } else if (config.right_analog_as_mouse && right_axis_movement) {
-          state.mouseX = state.current_right_analog_x / config.fake_mouse_scale;
-          state.mouseY = state.current_right_analog_y / config.fake_mouse_scale;
-        } else {
-          // Analogs trigger keys
-          if (!(state.textinputinteractive_mode_active)) {
-            handleAnalogTrigger(
-              state.current_left_analog_y < 0,
-              state.left_analog_was_up,
-              config.left_analog_up,
-              config.left_analog_up_modifier);
-            if ((state.current_left_analog_y < 0 ) && config.left_analog_up_repeat && (state.key_to_repeat == 0)) {
-                setKeyRepeat(config.left_analog_up, true);
-            } else if ((state.current_left_analog_y == 0 ) && config.left_analog_up_repeat && (state.key_to_repeat == config.left_analog_up)) {
-                setKeyRepeat(config.left_analog_up, false);
-            }
+void cacheReloadedConfig(const struct stat& source)
+{
+  waitConfigCacheWriter();
+  config_cache_image* image = snapshotConfigCache();
+  image->source_mtime_ns = mtimeNanos(source);
+  image->source_size = source.st_size;
+  config_cache_writer = SDL_CreateThread(writeReloadedConfigCache, "gptokeyb-cache", image);
+  if (config_cache_writer == NULL) {
+    delete image;
+  }
+}
 
-            handleAnalogTrigger(
-              state.current_left_analog_y > 0,
-              state.left_analog_was_down,
-              config.left_analog_down,
-              config.left_analog_down_modifier);
-            if ((state.current_left_analog_y > 0 ) && config.left_analog_down_repeat && (state.key_to_repeat == 0)) {
-                setKeyRepeat(config.left_analog_down, true);
-            } else if ((state.current_left_analog_y == 0 ) && config.left_analog_down_repeat && (state.key_to_repeat == config.left_analog_down)) {
-                setKeyRepeat(config.left_analog_down, false);
-            }
+// runs on the event loop thread between two inputs, so handleEvent() sees either the old or the new
+// mapping as a whole; a config that can't be read or has errors leaves the old one in place.
+// Only the text parse is done here, the cache image is written from cacheReloadedConfig()
+void reloadConfig()
+{
+  Uint64 start_ns = monotonicNanos();
+  const config_settings previous = config;
+
+  struct stat source; // taken before parsing, the image is only written if the file still matches it
+  bool readable = (access(config_file_path, R_OK) == 0) && (stat(config_file_path, &source) == 0);
+  int read_errno = errno;
+  if (readable) {
+    config = config_defaults;
+    config_errors = 0;
+    readConfigFile(config_file_path);
+    config_load_stats.parse_ns = monotonicNanos() - start_ns;
+  }
+  if (!readable || (config_errors > 0)) {
+    config = previous;
+    buildMouseCurve();
+    buildTextGrid();
+    reload_stats.failures++;
+    if (readable) {
+      printf("config reload failed: %d config errors, keeping the previous mapping\n", config_errors);
+    } else {
+      printf("config reload failed: %s, keeping the previous mapping\n", strerror(read_errno));
+    }
+    return;
+  }
 
-            handleAnalogTrigger(
-              state.current_left_analog_x < 0,
-              state.left_analog_was_left,
-              config.left_analog_left,
-              config.left_analog_left_modifier);
-            if ((state.current_left_analog_x < 0 ) && config.left_analog_left_repeat && (state.key_to_repeat == 0)) {
-                setKeyRepeat(config.left_analog_left, true);
-            } else if ((state.current_left_analog_x == 0 ) && config.left_analog_left_repeat && (state.key_to_repeat == config.left_analog_left)) {
-                setKeyRepeat(config.left_analog_left, false);
-            }
+  // text still being typed is dropped rather than finished with the new mapping, the keys it holds are released below
+  key_sequence.steps.clear();
+  key_sequence.next = 0;
+  key_sequence.due_ns = 0;
+  releaseHeldInputs();
+  int released = releaseHeldKeys();
+  reportUndeclaredCodes();
+  Uint64 reload_us = (monotonicNanos() - start_ns) / 1000;
+  reload_stats.last_us = reload_us;
+  reload_stats.reloads++;
+  printf("config %s reloaded in %llu us, %d held keys released\n", config_file_path, (unsigned long long)reload_us, released);
+  cacheReloadedConfig(source);
+}
 
-            handleAnalogTrigger(
-              state.current_left_analog_x > 0,
-              state.left_analog_was_right,
-              config.left_analog_right,
-              config.left_analog_right_modifier);
-            if ((state.current_left_analog_x > 0 ) && config.left_analog_right_repeat && (state.key_to_repeat == 0)) {
-                setKeyRepeat(config.left_analog_right, true);
-            } else if ((state.current_left_analog_x == 0 ) && config.left_analog_right_repeat && (state.key_to_repeat == config.left_analog_right)) {
-                setKeyRepeat(config.left_analog_right, false);
-            }
+void readConfigChanges()
+{
+  alignas(struct inotify_event) char buffer[4096];
+  bool changed = false;
+  ssize_t len;
+  while ((len = read(config_inotify_fd, buffer, sizeof(buffer))) > 0) {
+    for (char* ptr = buffer; ptr < buffer + len; ptr += sizeof(struct inotify_event) + ((struct inotify_event*)ptr)->len) {
+      const struct inotify_event* event = (const struct inotify_event*)ptr;
+      if ((event->len > 0) && (config_watch_name == event->name)) {
+        changed = true;
+      }
+    }
+  }
+  if (changed) { // several writes to the file in one wakeup make one reload
+    reloadConfig();
+  }
+}
 
-            handleAnalogTrigger(
-              state.current_right_analog_y < 0,
-              state.right_analog_was_up,
-              config.right_analog_up,
-              config.right_analog_up_modifier);
-            if ((state.current_right_analog_y < 0 ) && config.right_analog_up_repeat && (state.key_to_repeat == 0)) {
-                setKeyRepeat(config.right_analog_up, true);
-            } else if ((state.current_right_analog_y == 0 ) && config.right_analog_up_repeat && (state.key_to_repeat == config.right_analog_up)) {
-                setKeyRepeat(config.right_analog_up, false);
-            }
+void readSdlEvents()
+{
+  SDL_Event event;
+  while (true) {
+    ssize_t size = read(sdl_event_pipe[0], &event, sizeof(event));
+    if (size == 0) {
+      loop_running = false; // SDL event thread is gone
+      return;
+    } else if (size != sizeof(event)) {
+      return; // drained
+    }
+    if (!handleEvent(event)) {
+      stopEventLoop();
+      return;
+    }
+  }
+}
 
-            handleAnalogTrigger(
-              state.current_right_analog_y > 0,
-              state.right_analog_was_down,
-              config.right_analog_down,
-              config.right_analog_down_modifier);
-            if ((state.current_right_analog_y > 0 ) && config.right_analog_down_repeat && (state.key_to_repeat == 0)) {
-                setKeyRepeat(config.right_analog_down, true);
-            } else if ((state.current_right_analog_y == 0 ) && config.right_analog_down_repeat && (state.key_to_repeat == config.right_analog_down)) {
-                setKeyRepeat(config.right_analog_down, false);
-            }
+// starts launched.argv in its own process group and cgroup, and watches for it to exit
+bool launchApp()
+{
+  int procs_fd = createLaunchCgroup();
+  sigset_t sigchld_mask, previous_mask;
+  sigemptyset(&sigchld_mask);
+  sigaddset(&sigchld_mask, SIGCHLD);
+  sigprocmask(SIG_BLOCK, &sigchld_mask, &previous_mask); // no exit can be missed before the signalfd exists
+
+  launched.pid = fork();
+  if (launched.pid == 0) {
+    setpgid(0, 0);
+    if (procs_fd >= 0) {
+      write(procs_fd, "0", 1); // moves the writer, before anything else runs
+    }
+    sigset_t no_signals;
+    sigemptyset(&no_signals);
+    sigprocmask(SIG_SETMASK, &no_signals, NULL); // the app must not inherit anything we block
+    execvp(launched.argv[0], launched.argv);
+    perror(launched.argv[0]);
+    _exit(127);
+  }
+  if (procs_fd >= 0) {
+    close(procs_fd);
+  }
+  if (launched.pid < 0) {
+    perror("fork()");
+    removeLaunchCgroup(0);
+    return false;
+  }
+  setpgid(launched.pid, launched.pid); // also from here, so kill mode can't see it half set up
 
-            handleAnalogTrigger(
-              state.current_right_analog_x < 0,
-              state.right_analog_was_left,
-              config.right_analog_left,
-              config.right_analog_left_modifier);
-            if ((state.current_right_analog_x < 0 ) && config.right_analog_left_repeat && (state.key_to_repeat == 0)) {
-                setKeyRepeat(config.right_analog_left, true);
-            } else if ((state.current_right_analog_x == 0 ) && config.right_analog_left_repeat && (state.key_to_repeat == config.right_analog_left)) {
-                setKeyRepeat(config.right_analog_left, false);
-            }
+  launched.pidfd = syscall(SYS_pidfd_open, launched.pid, 0);
+  if (launched.pidfd < 0) {
+    launched.sigchld_fd = signalfd(-1, &sigchld_mask, SFD_NONBLOCK | SFD_CLOEXEC);
+  } else {
+    sigprocmask(SIG_SETMASK, &previous_mask, NULL);
+  }
+  printf("launched %s as pid %d%s%s\n", AppToKill, launched.pid,
+    launched.cgroup.empty() ? "" : " in ", launched.cgroup.c_str());
+  return true;
+}
 
-            handleAnalogTrigger(
-              state.current_right_analog_x > 0,
-              state.right_analog_was_right,
-              config.right_analog_right,
-              config.right_analog_right_modifier);
-            if ((state.current_right_analog_x > 0 ) && config.right_analog_right_repeat && (state.key_to_repeat == 0)) {
-                setKeyRepeat(config.right_analog_right, true);
-            } else if ((state.current_right_analog_x == 0 ) && config.right_analog_right_repeat && (state.key_to_repeat == config.right_analog_right)) {
-                setKeyRepeat(config.right_analog_right, false);
-            }
-          } //!(state.textinputinteractive_mode_active)
-        } // Analogs trigger keys 
-
-        if (state.hotkey_pressed) {
-          handleAnalogTrigger(
-            state.current_l2 > config.deadzone_triggers,
-            state.l2_hk_was_pressed,
-            config.l2_hk,
-            config.l2_hk_modifier);
-          handleAnalogTrigger(
-            state.current_r2 > config.deadzone_triggers,
-            state.r2_hk_was_pressed,
-            config.r2_hk,
-            config.r2_hk_modifier);
-          if (state.l2_hk_was_pressed || state.r2_hk_was_pressed) state.hotkey_combo_triggered = true;
-        } else if (state.l2_hk_was_pressed || state.r2_hk_was_pressed) {
-          handleAnalogTrigger(
-            state.current_l2 > config.deadzone_triggers,
-            state.l2_hk_was_pressed,
-            config.l2_hk,
-            config.l2_hk_modifier);
-          handleAnalogTrigger(
-            state.current_r2 > config.deadzone_triggers,
-            state.r2_hk_was_pressed,
-            config.r2_hk,
-            config.r2_hk_modifier);
-        } else {
-          handleAnalogTrigger(
-            state.current_l2 > config.deadzone_triggers,
-            state.l2_was_pressed,
-            config.l2,
-            config.l2_modifier);
-          handleAnalogTrigger(
-            state.current_r2 > config.deadzone_triggers,
-            state.r2_was_pressed,
-            config.r2,
-            config.r2_modifier);
-        }
-      } // end of else for indicating which axis was moved before checking whether it's assigned as mouse
-      break;
-    case SDL_CONTROLLERDEVICEADDED:
-      if (xbox360_mode == true || config_mode == true) {
-        SDL_GameControllerOpen(0);
-        /* SDL_GameController* controller = SDL_GameControllerOpen(0);
-     if (controller) {
-                      const char *name = SDL_GameControllerNameForIndex(0);
-                          printf("Joystick %i has game controller name '%s'\n", 0, name);
-                  }
-  */
-      } else {
-        SDL_GameControllerOpen(event.cdevice.which);
+// gptokeyb has nothing left to do once the launched app has exited
+void readLaunchedApp()
+{
+  if (launched.sigchld_fd >= 0) {
+    struct signalfd_siginfo info;
+    while (read(launched.sigchld_fd, &info, sizeof(info)) > 0) {
+      // just drain it, one SIGCHLD may stand for several exits
+    }
+  }
+  if (reapLaunchedApp()) {
+    // what it left running, like the game a launcher script started, goes with it instead of outliving its cgroup
+    if (!launchedTreeGone(0)) {
+      printf("closing what %s left running\n", AppToKill);
+      signalLaunchedTree(SIGTERM);
+      if (!launchedTreeGone(kill_grace_ms)) {
+        signalLaunchedTree(SIGKILL);
       }
-      break;
+    }
+    removeLaunchCgroup(kill_grace_ms);
+    stopEventLoop();
+  }
+}
 
-    case SDL_CONTROLLERDEVICEREMOVED:
-      if (
-        SDL_GameController* controller =
-          SDL_GameControllerFromInstanceID(event.cdevice.which)) {
-        SDL_GameControllerClose(controller);
+// SIGTERM and SIGINT end the event loop like SDL_QUIT, so held keys are released on the way out
+void readQuitSignal()
+{
+  struct signalfd_siginfo info;
+  while (read(quit_signal_fd, &info, sizeof(info)) > 0) {
+    printf("%s received, exiting\n", strsignal(info.ssi_signo));
+  }
+  stopEventLoop();
+}
+
+// SDL has no descriptor to wait on, so a thread waits for its events and passes them on through
+// a pipe; they are all handled on the event loop thread. Everything SDL has queued goes in one write,
+// so the events of one poll of the controller (both axes of a diagonal stick) are handled in one
+// wakeup and sent in one report
+#define SDL_FORWARD_EVENTS 64
+static_assert(SDL_FORWARD_EVENTS * sizeof(SDL_Event) <= PIPE_BUF, "a forwarded batch must be one atomic write");
+
+int forwardSdlEvents(void* /*data*/)
+{
+  SDL_Event events[SDL_FORWARD_EVENTS];
+  bool quit = false;
+  while (!quit && SDL_WaitEvent(&events[0])) {
+    int total = 1;
+    quit = (events[0].type == SDL_QUIT);
+    while (!quit && (total < SDL_FORWARD_EVENTS) && SDL_PollEvent(&events[total])) {
+      quit = (events[total++].type == SDL_QUIT);
+    }
+    ssize_t written;
+    do {
+      written = write(sdl_event_pipe[1], events, total * sizeof(SDL_Event));
+    } while ((written < 0) && (errno == EINTR));
+  }
+  close(sdl_event_pipe[1]);
+  return 0;
+}
+
+void armLoopTimer(Uint64 deadline_ns)
+{
+  struct itimerspec timer;
+  memset(&timer, 0, sizeof(timer));
+  timer.it_value.tv_sec = deadline_ns / 1000000000ULL; // all zero disarms it
+  timer.it_value.tv_nsec = deadline_ns % 1000000000ULL;
+  timerfd_settime(loop_timer_fd, TFD_TIMER_ABSTIME, &timer, NULL);
+}
+
+int runEventLoop()
+{
+  loop_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  loop_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if ((loop_epoll_fd < 0) || (loop_timer_fd < 0)) {
+    perror("epoll_create1()/timerfd_create()");
+    return -1;
+  }
+  addLoopSource(loop_timer_fd, LOOP_SOURCE_TIMER);
+
+  if (evdev_backend) {
+    if (uinput_device != NULL) {
+      uinput_devnode = libevdev_uinput_get_devnode(uinput_device);
+    }
+    // pick up controllers that are plugged in later; device permissions are set after creation
+    evdev_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (evdev_inotify_fd >= 0) {
+      inotify_add_watch(evdev_inotify_fd, "/dev/input", IN_CREATE | IN_ATTRIB);
+      addLoopSource(evdev_inotify_fd, LOOP_SOURCE_HOTPLUG);
+    }
+    scanEvdevPads();
+  } else {
+    addLoopSource(sdl_event_pipe[0], LOOP_SOURCE_SDL);
+  }
+  if (config_file_path != NULL) {
+    watchConfigFile();
+  }
+  if (launched.pid > 0) {
+    addLoopSource((launched.pidfd >= 0) ? launched.pidfd : launched.sigchld_fd, LOOP_SOURCE_APP);
+  }
+  if (quit_signal_fd >= 0) {
+    addLoopSource(quit_signal_fd, LOOP_SOURCE_QUIT);
+  }
+
+  loop_stats.start_ns = monotonicNanos();
+  Uint64 armed_deadline_ns = 0;
+  struct epoll_event ready[EVDEV_MAX_PADS + 6];
+  while (loop_running) {
+    Uint64 deadline_ns = nextTimerDeadline();
+    if (deadline_ns != armed_deadline_ns) {
+      armLoopTimer(deadline_ns);
+      armed_deadline_ns = deadline_ns;
+    }
+
+    int total = epoll_wait(loop_epoll_fd, ready, EVDEV_MAX_PADS + 6, -1);
+    if (total < 0) {
+      if (errno == EINTR) {
+        continue; // SIGUSR1
       }
-      break;
+      perror("epoll_wait()");
+      return -1;
+    }
+    loop_stats.wakeups.fetch_add(1, std::memory_order_relaxed);
+
+    for (int ii = 0; ii < total; ii++) {
+      Uint32 source = ready[ii].data.u32;
+      if (source == LOOP_SOURCE_TIMER) {
+        uint64_t expirations;
+        read(loop_timer_fd, &expirations, sizeof(expirations));
+        armed_deadline_ns = 0; // one-shot, has to be armed again
+        loop_stats.timer_wakeups.fetch_add(1, std::memory_order_relaxed);
+      } else if (source == LOOP_SOURCE_SDL) {
+        readSdlEvents();
+      } else if (source == LOOP_SOURCE_CONFIG) {
+        readConfigChanges();
+      } else if (source == LOOP_SOURCE_APP) {
+        readLaunchedApp();
+      } else if (source == LOOP_SOURCE_QUIT) {
+        readQuitSignal();
+      } else if (source == LOOP_SOURCE_HOTPLUG) {
+        char buffer[4096];
+        while (read(evdev_inotify_fd, buffer, sizeof(buffer)) > 0) {
+          // just drain it, the directory is rescanned below
+        }
+        scanEvdevPads();
+      } else if ((source < EVDEV_MAX_PADS) && (evdev_pads[source].device != NULL)) {
+        readEvdevPad(evdev_pads[source]);
+      }
+    }
 
-    case SDL_QUIT:
-      return false;
-      break;
+    runDueTimers(monotonicNanos());
+    flushEmitBatch(); // everything handled in this wakeup goes out as one report
   }
+  waitConfigCacheWriter(); // not left half written
+  return 0;
+}
 
-  return true;
+// every fake device lets go of what it still holds before it is destroyed; readers lose what they have
+// not read yet when a device goes away, so they are given a moment to read the releases
+#define TEARDOWN_READ_MS 50
+
+void closeFakeDevices()
+{
+  flushEmitBatch();
+  emit_fd = uinp_fd;
+  held = &device_ledger;
+  int released = releaseHeldKeys();
+  for (pad_slot& pad : pads) {
+    if ((pad.uinput != NULL) && (pad.uinput != uinput_device)) {
+      emitToPad(pad);
+      released += releaseHeldKeys();
+    }
+  }
+  if ((released > 0) && !launched.exited) { // nobody is left to read them once the app has exited
+    SDL_Delay(TEARDOWN_READ_MS);
+  }
+
+  for (pad_slot& pad : pads) {
+    if ((pad.uinput != NULL) && (pad.uinput != uinput_device)) {
+      libevdev_uinput_destroy(pad.uinput);
+      close(pad.uinput_fd);
+      pad.uinput = NULL;
+    }
+  }
+  if (uinput_device != NULL) {
+    libevdev_uinput_destroy(uinput_device);
+  }
+  if (uinput_description != NULL) {
+    libevdev_free(uinput_description);
+  }
+  close(uinp_fd);
+}
+
+void printLoopStats()
+{
+  Uint64 elapsed_ms = std::max<Uint64>((monotonicNanos() - loop_stats.start_ns) / 1000000ULL, 1);
+  unsigned long wakeups = loop_stats.wakeups;
+  printf("event loop woke up %lu times in %.1f s (%lu for timers, %.1f/s)\n",
+    wakeups, elapsed_ms / 1000.0, (unsigned long)loop_stats.timer_wakeups, wakeups * 1000.0 / elapsed_ms);
+}
+
+// what every backend leaves behind once the event loop has stopped
+void closeSession()
+{
+  flushEmitBatch();
+  if (trace_record_file != NULL) {
+    fclose(trace_record_file);
+  }
+  printEmitStats();
+  printLoopStats();
+  reapExitSplash();
+  closeFakeDevices();
 }
 
+#ifndef GPTOKEYB_NO_MAIN // bench/bench.cpp includes this file and provides its own main()
 int main(int argc, char* argv[])
 {
   const char* config_file = nullptr;
@@ -2541,7 +4544,18 @@ int main(int argc, char* argv[])
   // Add textinput_preset environment variable if available
   if (char* env_textinput = SDL_getenv("TEXTINPUTPRESET")) {
     textinputpreset_mode = true;
-    config.text_input_preset = env_textinput;
+    text_input_preset = env_textinput;
+  }
+
+  const char* text_layout_name = SDL_getenv("TEXTINPUTLAYOUT");
+  if ((text_layout_name == NULL) || !selectTextLayout(text_layout_name)) {
+    if (text_layout_name != NULL) {
+      printf("unknown text input layout %s, using us\n", text_layout_name);
+    }
+    selectTextLayout("us");
+  }
+  if (char* env_textinput_unicode = SDL_getenv("TEXTINPUTUNICODE")) {
+    setUnicodeEntryKeys(env_textinput_unicode);
   }
 
   // Add textinput_interactive environment variable if available
@@ -2558,6 +4572,9 @@ int main(int argc, char* argv[])
       pckill_mode = true;
     }
   }
+  if (char* env_kill_grace = SDL_getenv("KILLGRACE")) {
+    kill_grace_ms = std::max(atoi(env_kill_grace), 0);
+  }
 
   if (argc > 1) {
     config_mode = false;
@@ -2568,6 +4585,27 @@ int main(int argc, char* argv[])
   {      
     if (strcmp(argv[ii], "xbox360") == 0) {
       xbox360_mode = true;
+    } else if (strcmp(argv[ii], "-evdev") == 0) {
+      evdev_backend = true;
+    } else if (strcmp(argv[ii], "-record") == 0) {
+      if (ii + 1 < argc) {
+        trace_record_file = fopen(argv[++ii], "wbe");
+        if (trace_record_file == NULL) {
+          perror("fopen()");
+          return -1;
+        }
+        fwrite(TRACE_MAGIC, 8, 1, trace_record_file);
+      }
+    } else if (strcmp(argv[ii], "-replay") == 0) {
+      if (ii + 1 < argc) {
+        trace_replay_file = argv[++ii];
+      }
+    } else if (strcmp(argv[ii], "-replay-max") == 0) {
+      skip_emit_pauses = true;
+    } else if (strcmp(argv[ii], "-replay-dump") == 0) {
+      if (ii + 1 < argc) {
+        trace_dump_file = argv[++ii];
+      }
     } else if (strcmp(argv[ii], "textinput") == 0) {
       textinputinteractive_mode = true;
       state.textinputinteractive_mode_active = false;
@@ -2599,7 +4637,27 @@ int main(int argc, char* argv[])
         }
       }
       
-    } 
+    } else if (strcmp(argv[ii], "--") == 0) { // the rest is the app to launch and close
+      if (ii + 1 < argc) {
+        kill_mode = true;
+        launched.argv = &argv[ii + 1];
+        const char* slash = strrchr(argv[ii + 1], '/');
+        AppToKill = slash ? (char*)slash + 1 : argv[ii + 1];
+      }
+      break;
+    }
+  }
+
+  // the hotkey can be any button, by its config file name
+  if (hotkey_override) {
+    for (int button = 0; button <= SDL_CONTROLLER_BUTTON_DPAD_RIGHT; button++) {
+      if (strcmp(hotkey_code, binding_input_names[button]) == 0) {
+        hotkey_button = button;
+      }
+    }
+    if (hotkey_button < 0) {
+      printf("unknown hotkey %s\n", hotkey_code);
+    }
   }
 
   // Add textinput_interactive mode, check for extra options via environment variable if available
@@ -2619,34 +4677,32 @@ int main(int argc, char* argv[])
 
   // Create fake input device (not needed in kill mode)
   //if (!kill_mode) {  
-  if (config_mode || xbox360_mode || textinputinteractive_mode) { // initialise device, even in kill mode, now that kill mode will work with config & xbox modes
-    uinp_fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
-    if (uinp_fd < 0) {
+  if (config_mode || xbox360_mode || textinputinteractive_mode || trace_replay_file) { // initialise device, even in kill mode, now that kill mode will work with config & xbox modes
+    if (trace_replay_file == NULL) { // replayed events are kept in memory
+      uinp_fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC); // not inherited by a launched app
+    }
+    if ((uinp_fd < 0) && (trace_replay_file == NULL)) {
       printf("Unable to open /dev/uinput\n");
       return -1;
     }
-
-    // Intialize the uInput device to NULL
-    memset(&uidev, 0, sizeof(uidev));
-    uidev.id.version = 1;
-    uidev.id.bustype = BUS_USB;
+    emit_fd = uinp_fd;
 
     if (xbox360_mode) {
       printf("Running in Fake Xbox 360 Mode\n");
-      setupFakeXbox360Device(uidev, uinp_fd);
     } else {
       printf("Running in Fake Keyboard mode\n");
-      setupFakeKeyboardMouseDevice(uidev, uinp_fd);
 
       // if we are in config mode, read the file
       if (config_mode) {
         printf("Using ConfigFile %s\n", config_file);
-        readConfigFile(config_file);
+        loadConfig(config_file);
+        printConfigLoadStats();
+        config_file_path = config_file;
       }
       // if we are in textinput mode, note the text preset
       if (textinputpreset_mode) {
-        if (config.text_input_preset != NULL) {
-            printf("text input preset is %s\n", config.text_input_preset);
+        if (text_input_preset != NULL) {
+            printf("text input preset is %s\n", text_input_preset);
         } else {
             printf("text input preset is not set\n");
             //textinputpreset_mode = false;   removed so that Enter key can be pressed
@@ -2661,13 +4717,67 @@ int main(int argc, char* argv[])
         if (textinputinteractive_extrasymbols) printf("interactive text input mode includes extra symbols\n");
     
     }
-    // Create input device into input sub-system
-    write(uinp_fd, &uidev, sizeof(uidev));
 
-    if (ioctl(uinp_fd, UI_DEV_CREATE)) {
+    if (trace_replay_file != NULL) {
+      return replayTrace(trace_replay_file);
+    }
+
+    // Describe the device after the config is known, so only keys that can be emitted are declared
+    struct timespec setup_start, setup_end;
+    clock_gettime(CLOCK_MONOTONIC, &setup_start);
+
+    struct libevdev* device = libevdev_new();
+    libevdev_set_id_version(device, 1);
+    libevdev_set_id_bustype(device, BUS_USB);
+
+    if (xbox360_mode) {
+      setupFakeXbox360Device(device);
+    } else {
+      setupFakeKeyboardMouseDevice(device);
+    }
+
+    // Create input device into input sub-system (UI_DEV_SETUP/UI_ABS_SETUP where the kernel supports it)
+    if (libevdev_uinput_create_from_device(device, uinp_fd, &uinput_device) != 0) {
       printf("Unable to create UINPUT device.");
       return -1;
     }
+    clock_gettime(CLOCK_MONOTONIC, &setup_end);
+
+    printf("uinput device created in %ld us with %d key codes\n",
+      (setup_end.tv_sec - setup_start.tv_sec) * 1000000L + (setup_end.tv_nsec - setup_start.tv_nsec) / 1000L,
+      countKeyCodes(device));
+    uinput_description = device;
+  }
+
+  // SIGUSR1 dumps input latency percentiles
+  latency_dump_file = SDL_getenv("GPTOKEYB_LATENCY_FILE");
+  struct sigaction latency_action;
+  memset(&latency_action, 0, sizeof(latency_action));
+  latency_action.sa_handler = dumpLatencyHistograms;
+  latency_action.sa_flags = SA_RESTART;
+  sigaction(SIGUSR1, &latency_action, NULL);
+
+  // the app is started once the fake device exists, so it finds it when it looks for input devices
+  if ((launched.argv != NULL) && !launchApp()) {
+    return -1;
+  }
+
+  // SIGTERM and SIGINT are read by the event loop, blocked before any thread is started so none of them takes it
+  sigset_t quit_signals;
+  sigemptyset(&quit_signals);
+  sigaddset(&quit_signals, SIGTERM);
+  sigaddset(&quit_signals, SIGINT);
+  sigprocmask(SIG_BLOCK, &quit_signals, NULL);
+  quit_signal_fd = signalfd(-1, &quit_signals, SFD_NONBLOCK | SFD_CLOEXEC);
+
+  // Native evdev input, SDL is not initialised at all
+  if (evdev_backend) {
+    printf("Reading controllers through evdev\n");
+    if (runEventLoop() != 0) {
+      return -1;
+    }
+    closeSession();
+    return launched.exit_status;
   }
 
   if (const char* db_file = SDL_getenv("SDL_GAMECONTROLLERCONFIG_FILE")) {
@@ -2675,41 +4785,31 @@ int main(int argc, char* argv[])
   }
 
   // SDL initialization and main loop
-  if (SDL_Init(SDL_INIT_GAMECONTROLLER | SDL_INIT_TIMER) != 0) {
+  if (SDL_Init(SDL_INIT_GAMECONTROLLER) != 0) {
     printf("SDL_Init() failed: %s\n", SDL_GetError());
     return -1;
   }
+  sdl_ticks_origin_ns = monotonicNanos() - SDL_GetTicks() * 1000000ULL;
 
-  SDL_Event event;
-  bool running = true;
-  while (running) {
-    if (state.mouseX != 0 || state.mouseY != 0) {
-      while (running && SDL_PollEvent(&event)) {
-        running = handleEvent(event);
-      }
-
-      emitMouseMotion(state.mouseX, state.mouseY);
-      SDL_Delay(config.fake_mouse_delay);
-    } else {
-      if (!SDL_WaitEvent(&event)) {
-        printf("SDL_WaitEvent() failed: %s\n", SDL_GetError());
-        return -1;
-      }
+  if (pipe2(sdl_event_pipe, O_CLOEXEC) != 0) {
+    perror("pipe2()");
+    return -1;
+  }
+  fcntl(sdl_event_pipe[0], F_SETFL, O_NONBLOCK);
+  SDL_Thread* sdl_event_thread = SDL_CreateThread(forwardSdlEvents, "gptokeyb-sdl", NULL);
+  if (sdl_event_thread == NULL) {
+    printf("SDL_CreateThread() failed: %s\n", SDL_GetError());
+    return -1;
+  }
 
-      running = handleEvent(event);
-    }
+  if (runEventLoop() != 0) {
+    return -1;
   }
-  SDL_RemoveTimer( state.key_repeat_timer_id );
+  SDL_WaitThread(sdl_event_thread, NULL);
   SDL_Quit();
 
-  /*
-    * Give userspace some time to read the events before we destroy the
-    * device with UI_DEV_DESTROY.
-    */
-  sleep(1);
-
   /* Clean up */
-  ioctl(uinp_fd, UI_DEV_DESTROY);
-  close(uinp_fd);
-  return 0;
+  closeSession();
+  return launched.exit_status;
 }
+#endif // GPTOKEYB_NO_MAIN
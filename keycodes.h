@@ -0,0 +1,1322 @@
+/* Copyright (c) 2021
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public
+* License as published by the Free Software Foundation; either
+* version 2 of the License, or (at your option) any later version.
+#
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* General Public License for more details.
+#
+* You should have received a copy of the GNU General Public
+* License along with this program; if not, write to the
+* Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+* Boston, MA 02110-1301 USA
+#
+* Key names accepted in config files, for every KEY_* and BTN_* code in linux/input-event-codes.h:
+* KEY_LEFTSHIFT is "leftshift", BTN_LEFT is "btn_left". Codes are numbers rather than the KEY_*
+* macros so that the table builds against old kernel headers too.
+*/
+
+#ifndef GPTOKEYB_KEYCODES_H
+#define GPTOKEYB_KEYCODES_H
+
+struct keycode_name
+{
+  const char* name;
+  short code;
+};
+
+// sorted by name (strcmp order) for binary search, checked at compile time
+constexpr keycode_name keycode_names[] = {
+  {" ", 57}, // KEY_SPACE; text input
+  {"!", 2}, // KEY_1; with SHIFT
+  {"\"", 40}, // KEY_APOSTROPHE; with SHIFT, dead key
+  {"#", 4}, // KEY_3; with SHIFT
+  {"$", 5}, // KEY_4; with SHIFT
+  {"%", 6}, // KEY_5; with SHIFT
+  {"&", 8}, // KEY_7; with SHIFT
+  {"'", 40}, // KEY_APOSTROPHE; dead key
+  {"(", 10}, // KEY_9; with SHIFT
+  {")", 11}, // KEY_0; with SHIFT
+  {"*", 9}, // KEY_8; with SHIFT; alternative is kpasterisk
+  {"+", 13}, // KEY_EQUAL; with SHIFT; alternative is kpplus
+  {",", 51}, // KEY_COMMA
+  {"-", 12}, // KEY_MINUS; alternative is kpminus
+  {".", 52}, // KEY_DOT
+  {"/", 53}, // KEY_SLASH
+  {"0", 11}, // KEY_0
+  {"1", 2}, // KEY_1
+  {"102nd", 86}, // KEY_102ND
+  {"10channelsdown", 441}, // KEY_10CHANNELSDOWN
+  {"10channelsup", 440}, // KEY_10CHANNELSUP
+  {"2", 3}, // KEY_2
+  {"3", 4}, // KEY_3
+  {"3d_mode", 623}, // KEY_3D_MODE
+  {"4", 5}, // KEY_4
+  {"5", 6}, // KEY_5
+  {"6", 7}, // KEY_6
+  {"7", 8}, // KEY_7
+  {"8", 9}, // KEY_8
+  {"9", 10}, // KEY_9
+  {":", 39}, // KEY_SEMICOLON; with SHIFT
+  {";", 39}, // KEY_SEMICOLON
+  {"<", 51}, // KEY_COMMA; with SHIFT
+  {"=", 13}, // KEY_EQUAL
+  {">", 52}, // KEY_DOT; with SHIFT
+  {"?", 53}, // KEY_SLASH; with SHIFT
+  {"@", 3}, // KEY_2; with SHIFT
+  {"[", 26}, // KEY_LEFTBRACE
+  {"\\", 43}, // KEY_BACKSLASH
+  {"]", 27}, // KEY_RIGHTBRACE
+  {"^", 7}, // KEY_6; with SHIFT, dead key
+  {"_", 12}, // KEY_MINUS; with SHIFT
+  {"`", 41}, // KEY_GRAVE; dead key
+  {"a", 30}, // KEY_A
+  {"ab", 406}, // KEY_AB
+  {"addressbook", 429}, // KEY_ADDRESSBOOK
+  {"again", 129}, // KEY_AGAIN
+  {"all_applications", 204}, // KEY_ALL_APPLICATIONS
+  {"als_toggle", 560}, // KEY_ALS_TOGGLE
+  {"alt", 56}, // KEY_LEFTALT
+  {"alterase", 222}, // KEY_ALTERASE
+  {"angle", 371}, // KEY_ANGLE
+  {"apostrophe", 40}, // KEY_APOSTROPHE
+  {"appselect", 580}, // KEY_APPSELECT
+  {"archive", 361}, // KEY_ARCHIVE
+  {"aspect_ratio", 375}, // KEY_ASPECT_RATIO
+  {"assistant", 583}, // KEY_ASSISTANT
+  {"attendant_off", 540}, // KEY_ATTENDANT_OFF
+  {"attendant_on", 539}, // KEY_ATTENDANT_ON
+  {"attendant_toggle", 541}, // KEY_ATTENDANT_TOGGLE
+  {"audio", 392}, // KEY_AUDIO
+  {"audio_desc", 622}, // KEY_AUDIO_DESC
+  {"autopilot_engage_toggle", 637}, // KEY_AUTOPILOT_ENGAGE_TOGGLE
+  {"aux", 390}, // KEY_AUX
+  {"b", 48}, // KEY_B
+  {"back", 158}, // KEY_BACK
+  {"backslash", 43}, // KEY_BACKSLASH
+  {"backspace", 14}, // KEY_BACKSPACE
+  {"bassboost", 209}, // KEY_BASSBOOST
+  {"battery", 236}, // KEY_BATTERY
+  {"blue", 401}, // KEY_BLUE
+  {"bluetooth", 237}, // KEY_BLUETOOTH
+  {"bookmarks", 156}, // KEY_BOOKMARKS
+  {"break", 411}, // KEY_BREAK
+  {"brightness_auto", 244}, // KEY_BRIGHTNESS_AUTO
+  {"brightness_cycle", 243}, // KEY_BRIGHTNESS_CYCLE
+  {"brightness_max", 593}, // KEY_BRIGHTNESS_MAX
+  {"brightness_menu", 649}, // KEY_BRIGHTNESS_MENU
+  {"brightness_min", 592}, // KEY_BRIGHTNESS_MIN
+  {"brightness_toggle", 431}, // KEY_BRIGHTNESS_TOGGLE
+  {"brightness_zero", 244}, // KEY_BRIGHTNESS_ZERO
+  {"brightnessdown", 224}, // KEY_BRIGHTNESSDOWN
+  {"brightnessup", 225}, // KEY_BRIGHTNESSUP
+  {"brl_dot1", 497}, // KEY_BRL_DOT1
+  {"brl_dot10", 506}, // KEY_BRL_DOT10
+  {"brl_dot2", 498}, // KEY_BRL_DOT2
+  {"brl_dot3", 499}, // KEY_BRL_DOT3
+  {"brl_dot4", 500}, // KEY_BRL_DOT4
+  {"brl_dot5", 501}, // KEY_BRL_DOT5
+  {"brl_dot6", 502}, // KEY_BRL_DOT6
+  {"brl_dot7", 503}, // KEY_BRL_DOT7
+  {"brl_dot8", 504}, // KEY_BRL_DOT8
+  {"brl_dot9", 505}, // KEY_BRL_DOT9
+  {"btn_0", 256}, // BTN_0
+  {"btn_1", 257}, // BTN_1
+  {"btn_2", 258}, // BTN_2
+  {"btn_3", 259}, // BTN_3
+  {"btn_4", 260}, // BTN_4
+  {"btn_5", 261}, // BTN_5
+  {"btn_6", 262}, // BTN_6
+  {"btn_7", 263}, // BTN_7
+  {"btn_8", 264}, // BTN_8
+  {"btn_9", 265}, // BTN_9
+  {"btn_a", 304}, // BTN_A
+  {"btn_b", 305}, // BTN_B
+  {"btn_back", 278}, // BTN_BACK
+  {"btn_base", 294}, // BTN_BASE
+  {"btn_base2", 295}, // BTN_BASE2
+  {"btn_base3", 296}, // BTN_BASE3
+  {"btn_base4", 297}, // BTN_BASE4
+  {"btn_base5", 298}, // BTN_BASE5
+  {"btn_base6", 299}, // BTN_BASE6
+  {"btn_c", 306}, // BTN_C
+  {"btn_dead", 303}, // BTN_DEAD
+  {"btn_digi", 320}, // BTN_DIGI
+  {"btn_dpad_down", 545}, // BTN_DPAD_DOWN
+  {"btn_dpad_left", 546}, // BTN_DPAD_LEFT
+  {"btn_dpad_right", 547}, // BTN_DPAD_RIGHT
+  {"btn_dpad_up", 544}, // BTN_DPAD_UP
+  {"btn_east", 305}, // BTN_EAST
+  {"btn_extra", 276}, // BTN_EXTRA
+  {"btn_forward", 277}, // BTN_FORWARD
+  {"btn_gamepad", 304}, // BTN_GAMEPAD
+  {"btn_gear_down", 336}, // BTN_GEAR_DOWN
+  {"btn_gear_up", 337}, // BTN_GEAR_UP
+  {"btn_joystick", 288}, // BTN_JOYSTICK
+  {"btn_left", 272}, // BTN_LEFT
+  {"btn_middle", 274}, // BTN_MIDDLE
+  {"btn_misc", 256}, // BTN_MISC
+  {"btn_mode", 316}, // BTN_MODE
+  {"btn_mouse", 272}, // BTN_MOUSE
+  {"btn_north", 307}, // BTN_NORTH
+  {"btn_pinkie", 293}, // BTN_PINKIE
+  {"btn_right", 273}, // BTN_RIGHT
+  {"btn_select", 314}, // BTN_SELECT
+  {"btn_side", 275}, // BTN_SIDE
+  {"btn_south", 304}, // BTN_SOUTH
+  {"btn_start", 315}, // BTN_START
+  {"btn_stylus", 331}, // BTN_STYLUS
+  {"btn_stylus2", 332}, // BTN_STYLUS2
+  {"btn_stylus3", 329}, // BTN_STYLUS3
+  {"btn_task", 279}, // BTN_TASK
+  {"btn_thumb", 289}, // BTN_THUMB
+  {"btn_thumb2", 290}, // BTN_THUMB2
+  {"btn_thumbl", 317}, // BTN_THUMBL
+  {"btn_thumbr", 318}, // BTN_THUMBR
+  {"btn_tl", 310}, // BTN_TL
+  {"btn_tl2", 312}, // BTN_TL2
+  {"btn_tool_airbrush", 324}, // BTN_TOOL_AIRBRUSH
+  {"btn_tool_brush", 322}, // BTN_TOOL_BRUSH
+  {"btn_tool_doubletap", 333}, // BTN_TOOL_DOUBLETAP
+  {"btn_tool_finger", 325}, // BTN_TOOL_FINGER
+  {"btn_tool_lens", 327}, // BTN_TOOL_LENS
+  {"btn_tool_mouse", 326}, // BTN_TOOL_MOUSE
+  {"btn_tool_pen", 320}, // BTN_TOOL_PEN
+  {"btn_tool_pencil", 323}, // BTN_TOOL_PENCIL
+  {"btn_tool_quadtap", 335}, // BTN_TOOL_QUADTAP
+  {"btn_tool_quinttap", 328}, // BTN_TOOL_QUINTTAP
+  {"btn_tool_rubber", 321}, // BTN_TOOL_RUBBER
+  {"btn_tool_tripletap", 334}, // BTN_TOOL_TRIPLETAP
+  {"btn_top", 291}, // BTN_TOP
+  {"btn_top2", 292}, // BTN_TOP2
+  {"btn_touch", 330}, // BTN_TOUCH
+  {"btn_tr", 311}, // BTN_TR
+  {"btn_tr2", 313}, // BTN_TR2
+  {"btn_trigger", 288}, // BTN_TRIGGER
+  {"btn_trigger_happy", 704}, // BTN_TRIGGER_HAPPY
+  {"btn_trigger_happy1", 704}, // BTN_TRIGGER_HAPPY1
+  {"btn_trigger_happy10", 713}, // BTN_TRIGGER_HAPPY10
+  {"btn_trigger_happy11", 714}, // BTN_TRIGGER_HAPPY11
+  {"btn_trigger_happy12", 715}, // BTN_TRIGGER_HAPPY12
+  {"btn_trigger_happy13", 716}, // BTN_TRIGGER_HAPPY13
+  {"btn_trigger_happy14", 717}, // BTN_TRIGGER_HAPPY14
+  {"btn_trigger_happy15", 718}, // BTN_TRIGGER_HAPPY15
+  {"btn_trigger_happy16", 719}, // BTN_TRIGGER_HAPPY16
+  {"btn_trigger_happy17", 720}, // BTN_TRIGGER_HAPPY17
+  {"btn_trigger_happy18", 721}, // BTN_TRIGGER_HAPPY18
+  {"btn_trigger_happy19", 722}, // BTN_TRIGGER_HAPPY19
+  {"btn_trigger_happy2", 705}, // BTN_TRIGGER_HAPPY2
+  {"btn_trigger_happy20", 723}, // BTN_TRIGGER_HAPPY20
+  {"btn_trigger_happy21", 724}, // BTN_TRIGGER_HAPPY21
+  {"btn_trigger_happy22", 725}, // BTN_TRIGGER_HAPPY22
+  {"btn_trigger_happy23", 726}, // BTN_TRIGGER_HAPPY23
+  {"btn_trigger_happy24", 727}, // BTN_TRIGGER_HAPPY24
+  {"btn_trigger_happy25", 728}, // BTN_TRIGGER_HAPPY25
+  {"btn_trigger_happy26", 729}, // BTN_TRIGGER_HAPPY26
+  {"btn_trigger_happy27", 730}, // BTN_TRIGGER_HAPPY27
+  {"btn_trigger_happy28", 731}, // BTN_TRIGGER_HAPPY28
+  {"btn_trigger_happy29", 732}, // BTN_TRIGGER_HAPPY29
+  {"btn_trigger_happy3", 706}, // BTN_TRIGGER_HAPPY3
+  {"btn_trigger_happy30", 733}, // BTN_TRIGGER_HAPPY30
+  {"btn_trigger_happy31", 734}, // BTN_TRIGGER_HAPPY31
+  {"btn_trigger_happy32", 735}, // BTN_TRIGGER_HAPPY32
+  {"btn_trigger_happy33", 736}, // BTN_TRIGGER_HAPPY33
+  {"btn_trigger_happy34", 737}, // BTN_TRIGGER_HAPPY34
+  {"btn_trigger_happy35", 738}, // BTN_TRIGGER_HAPPY35
+  {"btn_trigger_happy36", 739}, // BTN_TRIGGER_HAPPY36
+  {"btn_trigger_happy37", 740}, // BTN_TRIGGER_HAPPY37
+  {"btn_trigger_happy38", 741}, // BTN_TRIGGER_HAPPY38
+  {"btn_trigger_happy39", 742}, // BTN_TRIGGER_HAPPY39
+  {"btn_trigger_happy4", 707}, // BTN_TRIGGER_HAPPY4
+  {"btn_trigger_happy40", 743}, // BTN_TRIGGER_HAPPY40
+  {"btn_trigger_happy5", 708}, // BTN_TRIGGER_HAPPY5
+  {"btn_trigger_happy6", 709}, // BTN_TRIGGER_HAPPY6
+  {"btn_trigger_happy7", 710}, // BTN_TRIGGER_HAPPY7
+  {"btn_trigger_happy8", 711}, // BTN_TRIGGER_HAPPY8
+  {"btn_trigger_happy9", 712}, // BTN_TRIGGER_HAPPY9
+  {"btn_west", 308}, // BTN_WEST
+  {"btn_wheel", 336}, // BTN_WHEEL
+  {"btn_x", 307}, // BTN_X
+  {"btn_y", 308}, // BTN_Y
+  {"btn_z", 309}, // BTN_Z
+  {"buttonconfig", 576}, // KEY_BUTTONCONFIG
+  {"c", 46}, // KEY_C
+  {"calc", 140}, // KEY_CALC
+  {"calendar", 397}, // KEY_CALENDAR
+  {"camera", 212}, // KEY_CAMERA
+  {"camera_down", 536}, // KEY_CAMERA_DOWN
+  {"camera_focus", 528}, // KEY_CAMERA_FOCUS
+  {"camera_left", 537}, // KEY_CAMERA_LEFT
+  {"camera_right", 538}, // KEY_CAMERA_RIGHT
+  {"camera_up", 535}, // KEY_CAMERA_UP
+  {"camera_zoomin", 533}, // KEY_CAMERA_ZOOMIN
+  {"camera_zoomout", 534}, // KEY_CAMERA_ZOOMOUT
+  {"cancel", 223}, // KEY_CANCEL
+  {"capslock", 58}, // KEY_CAPSLOCK
+  {"cd", 383}, // KEY_CD
+  {"channel", 363}, // KEY_CHANNEL
+  {"channeldown", 403}, // KEY_CHANNELDOWN
+  {"channelup", 402}, // KEY_CHANNELUP
+  {"chat", 216}, // KEY_CHAT
+  {"clear", 355}, // KEY_CLEAR
+  {"clearvu_sonar", 646}, // KEY_CLEARVU_SONAR
+  {"close", 206}, // KEY_CLOSE
+  {"closecd", 160}, // KEY_CLOSECD
+  {"coffee", 152}, // KEY_COFFEE
+  {"comma", 51}, // KEY_COMMA
+  {"compose", 127}, // KEY_COMPOSE
+  {"computer", 157}, // KEY_COMPUTER
+  {"config", 171}, // KEY_CONFIG
+  {"connect", 218}, // KEY_CONNECT
+  {"context_menu", 438}, // KEY_CONTEXT_MENU
+  {"controlpanel", 579}, // KEY_CONTROLPANEL
+  {"copy", 133}, // KEY_COPY
+  {"ctrl", 29}, // KEY_LEFTCTRL
+  {"cut", 137}, // KEY_CUT
+  {"cyclewindows", 154}, // KEY_CYCLEWINDOWS
+  {"d", 32}, // KEY_D
+  {"dashboard", 204}, // KEY_DASHBOARD
+  {"data", 631}, // KEY_DATA
+  {"database", 426}, // KEY_DATABASE
+  {"del_eol", 448}, // KEY_DEL_EOL
+  {"del_eos", 449}, // KEY_DEL_EOS
+  {"del_line", 451}, // KEY_DEL_LINE
+  {"delete", 111}, // KEY_DELETE
+  {"deletefile", 146}, // KEY_DELETEFILE
+  {"dictate", 586}, // KEY_DICTATE
+  {"digits", 413}, // KEY_DIGITS
+  {"direction", 153}, // KEY_DIRECTION
+  {"directory", 394}, // KEY_DIRECTORY
+  {"display_off", 245}, // KEY_DISPLAY_OFF
+  {"displaytoggle", 431}, // KEY_DISPLAYTOGGLE
+  {"documents", 235}, // KEY_DOCUMENTS
+  {"dollar", 434}, // KEY_DOLLAR
+  {"dot", 52}, // KEY_DOT
+  {"down", 108}, // KEY_DOWN
+  {"dual_range_radar", 643}, // KEY_DUAL_RANGE_RADAR
+  {"dvd", 389}, // KEY_DVD
+  {"e", 18}, // KEY_E
+  {"edit", 176}, // KEY_EDIT
+  {"editor", 422}, // KEY_EDITOR
+  {"ejectcd", 161}, // KEY_EJECTCD
+  {"ejectclosecd", 162}, // KEY_EJECTCLOSECD
+  {"email", 215}, // KEY_EMAIL
+  {"emoji_picker", 585}, // KEY_EMOJI_PICKER
+  {"end", 107}, // KEY_END
+  {"enter", 28}, // KEY_ENTER
+  {"epg", 365}, // KEY_EPG
+  {"equal", 13}, // KEY_EQUAL
+  {"esc", 1}, // KEY_ESC
+  {"euro", 435}, // KEY_EURO
+  {"exit", 174}, // KEY_EXIT
+  {"f", 33}, // KEY_F
+  {"f1", 59}, // KEY_F1
+  {"f10", 68}, // KEY_F10
+  {"f11", 87}, // KEY_F11
+  {"f12", 88}, // KEY_F12
+  {"f13", 183}, // KEY_F13
+  {"f14", 184}, // KEY_F14
+  {"f15", 185}, // KEY_F15
+  {"f16", 186}, // KEY_F16
+  {"f17", 187}, // KEY_F17
+  {"f18", 188}, // KEY_F18
+  {"f19", 189}, // KEY_F19
+  {"f2", 60}, // KEY_F2
+  {"f20", 190}, // KEY_F20
+  {"f21", 191}, // KEY_F21
+  {"f22", 192}, // KEY_F22
+  {"f23", 193}, // KEY_F23
+  {"f24", 194}, // KEY_F24
+  {"f3", 61}, // KEY_F3
+  {"f4", 62}, // KEY_F4
+  {"f5", 63}, // KEY_F5
+  {"f6", 64}, // KEY_F6
+  {"f7", 65}, // KEY_F7
+  {"f8", 66}, // KEY_F8
+  {"f9", 67}, // KEY_F9
+  {"fastforward", 208}, // KEY_FASTFORWARD
+  {"fastreverse", 629}, // KEY_FASTREVERSE
+  {"favorites", 364}, // KEY_FAVORITES
+  {"file", 144}, // KEY_FILE
+  {"finance", 219}, // KEY_FINANCE
+  {"find", 136}, // KEY_FIND
+  {"first", 404}, // KEY_FIRST
+  {"fishing_chart", 641}, // KEY_FISHING_CHART
+  {"fn", 464}, // KEY_FN
+  {"fn_1", 478}, // KEY_FN_1
+  {"fn_2", 479}, // KEY_FN_2
+  {"fn_b", 484}, // KEY_FN_B
+  {"fn_d", 480}, // KEY_FN_D
+  {"fn_e", 481}, // KEY_FN_E
+  {"fn_esc", 465}, // KEY_FN_ESC
+  {"fn_f", 482}, // KEY_FN_F
+  {"fn_f1", 466}, // KEY_FN_F1
+  {"fn_f10", 475}, // KEY_FN_F10
+  {"fn_f11", 476}, // KEY_FN_F11
+  {"fn_f12", 477}, // KEY_FN_F12
+  {"fn_f2", 467}, // KEY_FN_F2
+  {"fn_f3", 468}, // KEY_FN_F3
+  {"fn_f4", 469}, // KEY_FN_F4
+  {"fn_f5", 470}, // KEY_FN_F5
+  {"fn_f6", 471}, // KEY_FN_F6
+  {"fn_f7", 472}, // KEY_FN_F7
+  {"fn_f8", 473}, // KEY_FN_F8
+  {"fn_f9", 474}, // KEY_FN_F9
+  {"fn_right_shift", 485}, // KEY_FN_RIGHT_SHIFT
+  {"fn_s", 483}, // KEY_FN_S
+  {"forward", 159}, // KEY_FORWARD
+  {"forwardmail", 233}, // KEY_FORWARDMAIL
+  {"frameback", 436}, // KEY_FRAMEBACK
+  {"frameforward", 437}, // KEY_FRAMEFORWARD
+  {"front", 132}, // KEY_FRONT
+  {"full_screen", 372}, // KEY_FULL_SCREEN
+  {"g", 34}, // KEY_G
+  {"games", 417}, // KEY_GAMES
+  {"goto", 354}, // KEY_GOTO
+  {"graphicseditor", 424}, // KEY_GRAPHICSEDITOR
+  {"grave", 41}, // KEY_GRAVE
+  {"green", 399}, // KEY_GREEN
+  {"h", 35}, // KEY_H
+  {"hangeul", 122}, // KEY_HANGEUL
+  {"hanguel", 122}, // KEY_HANGUEL
+  {"hangup_phone", 446}, // KEY_HANGUP_PHONE
+  {"hanja", 123}, // KEY_HANJA
+  {"help", 138}, // KEY_HELP
+  {"henkan", 92}, // KEY_HENKAN
+  {"hiragana", 91}, // KEY_HIRAGANA
+  {"home", 102}, // KEY_HOME
+  {"homepage", 172}, // KEY_HOMEPAGE
+  {"hp", 211}, // KEY_HP
+  {"i", 23}, // KEY_I
+  {"images", 442}, // KEY_IMAGES
+  {"info", 358}, // KEY_INFO
+  {"ins_line", 450}, // KEY_INS_LINE
+  {"insert", 110}, // KEY_INSERT
+  {"iso", 170}, // KEY_ISO
+  {"j", 36}, // KEY_J
+  {"journal", 578}, // KEY_JOURNAL
+  {"k", 37}, // KEY_K
+  {"katakana", 90}, // KEY_KATAKANA
+  {"katakanahiragana", 93}, // KEY_KATAKANAHIRAGANA
+  {"kbd_layout_next", 584}, // KEY_KBD_LAYOUT_NEXT
+  {"kbd_lcd_menu1", 696}, // KEY_KBD_LCD_MENU1
+  {"kbd_lcd_menu2", 697}, // KEY_KBD_LCD_MENU2
+  {"kbd_lcd_menu3", 698}, // KEY_KBD_LCD_MENU3
+  {"kbd_lcd_menu4", 699}, // KEY_KBD_LCD_MENU4
+  {"kbd_lcd_menu5", 700}, // KEY_KBD_LCD_MENU5
+  {"kbdillumdown", 229}, // KEY_KBDILLUMDOWN
+  {"kbdillumtoggle", 228}, // KEY_KBDILLUMTOGGLE
+  {"kbdillumup", 230}, // KEY_KBDILLUMUP
+  {"kbdinputassist_accept", 612}, // KEY_KBDINPUTASSIST_ACCEPT
+  {"kbdinputassist_cancel", 613}, // KEY_KBDINPUTASSIST_CANCEL
+  {"kbdinputassist_next", 609}, // KEY_KBDINPUTASSIST_NEXT
+  {"kbdinputassist_nextgroup", 611}, // KEY_KBDINPUTASSIST_NEXTGROUP
+  {"kbdinputassist_prev", 608}, // KEY_KBDINPUTASSIST_PREV
+  {"kbdinputassist_prevgroup", 610}, // KEY_KBDINPUTASSIST_PREVGROUP
+  {"keyboard", 374}, // KEY_KEYBOARD
+  {"kp0", 82}, // KEY_KP0
+  {"kp1", 79}, // KEY_KP1
+  {"kp2", 80}, // KEY_KP2
+  {"kp3", 81}, // KEY_KP3
+  {"kp4", 75}, // KEY_KP4
+  {"kp5", 76}, // KEY_KP5
+  {"kp6", 77}, // KEY_KP6
+  {"kp7", 71}, // KEY_KP7
+  {"kp8", 72}, // KEY_KP8
+  {"kp9", 73}, // KEY_KP9
+  {"kpasterisk", 55}, // KEY_KPASTERISK
+  {"kpcomma", 121}, // KEY_KPCOMMA
+  {"kpdot", 83}, // KEY_KPDOT
+  {"kpenter", 96}, // KEY_KPENTER
+  {"kpequal", 117}, // KEY_KPEQUAL
+  {"kpjpcomma", 95}, // KEY_KPJPCOMMA
+  {"kpleftparen", 179}, // KEY_KPLEFTPAREN
+  {"kpminus", 74}, // KEY_KPMINUS
+  {"kpplus", 78}, // KEY_KPPLUS
+  {"kpplusminus", 118}, // KEY_KPPLUSMINUS
+  {"kprightparen", 180}, // KEY_KPRIGHTPAREN
+  {"kpslash", 98}, // KEY_KPSLASH
+  {"l", 38}, // KEY_L
+  {"language", 368}, // KEY_LANGUAGE
+  {"last", 405}, // KEY_LAST
+  {"left", 105}, // KEY_LEFT
+  {"left_down", 617}, // KEY_LEFT_DOWN
+  {"left_up", 616}, // KEY_LEFT_UP
+  {"leftalt", 56}, // KEY_LEFTALT
+  {"leftbrace", 26}, // KEY_LEFTBRACE
+  {"leftctrl", 29}, // KEY_LEFTCTRL
+  {"leftmeta", 125}, // KEY_LEFTMETA
+  {"leftshift", 42}, // KEY_LEFTSHIFT
+  {"lights_toggle", 542}, // KEY_LIGHTS_TOGGLE
+  {"linefeed", 101}, // KEY_LINEFEED
+  {"link_phone", 447}, // KEY_LINK_PHONE
+  {"list", 395}, // KEY_LIST
+  {"logoff", 433}, // KEY_LOGOFF
+  {"m", 50}, // KEY_M
+  {"macro", 112}, // KEY_MACRO
+  {"macro1", 656}, // KEY_MACRO1
+  {"macro10", 665}, // KEY_MACRO10
+  {"macro11", 666}, // KEY_MACRO11
+  {"macro12", 667}, // KEY_MACRO12
+  {"macro13", 668}, // KEY_MACRO13
+  {"macro14", 669}, // KEY_MACRO14
+  {"macro15", 670}, // KEY_MACRO15
+  {"macro16", 671}, // KEY_MACRO16
+  {"macro17", 672}, // KEY_MACRO17
+  {"macro18", 673}, // KEY_MACRO18
+  {"macro19", 674}, // KEY_MACRO19
+  {"macro2", 657}, // KEY_MACRO2
+  {"macro20", 675}, // KEY_MACRO20
+  {"macro21", 676}, // KEY_MACRO21
+  {"macro22", 677}, // KEY_MACRO22
+  {"macro23", 678}, // KEY_MACRO23
+  {"macro24", 679}, // KEY_MACRO24
+  {"macro25", 680}, // KEY_MACRO25
+  {"macro26", 681}, // KEY_MACRO26
+  {"macro27", 682}, // KEY_MACRO27
+  {"macro28", 683}, // KEY_MACRO28
+  {"macro29", 684}, // KEY_MACRO29
+  {"macro3", 658}, // KEY_MACRO3
+  {"macro30", 685}, // KEY_MACRO30
+  {"macro4", 659}, // KEY_MACRO4
+  {"macro5", 660}, // KEY_MACRO5
+  {"macro6", 661}, // KEY_MACRO6
+  {"macro7", 662}, // KEY_MACRO7
+  {"macro8", 663}, // KEY_MACRO8
+  {"macro9", 664}, // KEY_MACRO9
+  {"macro_preset1", 691}, // KEY_MACRO_PRESET1
+  {"macro_preset2", 692}, // KEY_MACRO_PRESET2
+  {"macro_preset3", 693}, // KEY_MACRO_PRESET3
+  {"macro_preset_cycle", 690}, // KEY_MACRO_PRESET_CYCLE
+  {"macro_record_start", 688}, // KEY_MACRO_RECORD_START
+  {"macro_record_stop", 689}, // KEY_MACRO_RECORD_STOP
+  {"mail", 155}, // KEY_MAIL
+  {"mark_waypoint", 638}, // KEY_MARK_WAYPOINT
+  {"media", 226}, // KEY_MEDIA
+  {"media_repeat", 439}, // KEY_MEDIA_REPEAT
+  {"media_top_menu", 619}, // KEY_MEDIA_TOP_MENU
+  {"memo", 396}, // KEY_MEMO
+  {"menu", 139}, // KEY_MENU
+  {"messenger", 430}, // KEY_MESSENGER
+  {"mhp", 367}, // KEY_MHP
+  {"micmute", 248}, // KEY_MICMUTE
+  {"minus", 12}, // KEY_MINUS
+  {"mode", 373}, // KEY_MODE
+  {"mouse_left", 272}, // BTN_LEFT
+  {"mouse_right", 273}, // BTN_RIGHT
+  {"move", 175}, // KEY_MOVE
+  {"mp3", 391}, // KEY_MP3
+  {"msdos", 151}, // KEY_MSDOS
+  {"muhenkan", 94}, // KEY_MUHENKAN
+  {"mute", 113}, // KEY_MUTE
+  {"n", 49}, // KEY_N
+  {"nav_chart", 640}, // KEY_NAV_CHART
+  {"nav_info", 648}, // KEY_NAV_INFO
+  {"new", 181}, // KEY_NEW
+  {"news", 427}, // KEY_NEWS
+  {"next", 407}, // KEY_NEXT
+  {"next_element", 635}, // KEY_NEXT_ELEMENT
+  {"next_favorite", 624}, // KEY_NEXT_FAVORITE
+  {"nextsong", 163}, // KEY_NEXTSONG
+  {"notification_center", 444}, // KEY_NOTIFICATION_CENTER
+  {"numeric_0", 512}, // KEY_NUMERIC_0
+  {"numeric_1", 513}, // KEY_NUMERIC_1
+  {"numeric_11", 620}, // KEY_NUMERIC_11
+  {"numeric_12", 621}, // KEY_NUMERIC_12
+  {"numeric_2", 514}, // KEY_NUMERIC_2
+  {"numeric_3", 515}, // KEY_NUMERIC_3
+  {"numeric_4", 516}, // KEY_NUMERIC_4
+  {"numeric_5", 517}, // KEY_NUMERIC_5
+  {"numeric_6", 518}, // KEY_NUMERIC_6
+  {"numeric_7", 519}, // KEY_NUMERIC_7
+  {"numeric_8", 520}, // KEY_NUMERIC_8
+  {"numeric_9", 521}, // KEY_NUMERIC_9
+  {"numeric_a", 524}, // KEY_NUMERIC_A
+  {"numeric_b", 525}, // KEY_NUMERIC_B
+  {"numeric_c", 526}, // KEY_NUMERIC_C
+  {"numeric_d", 527}, // KEY_NUMERIC_D
+  {"numeric_pound", 523}, // KEY_NUMERIC_POUND
+  {"numeric_star", 522}, // KEY_NUMERIC_STAR
+  {"numlock", 69}, // KEY_NUMLOCK
+  {"o", 24}, // KEY_O
+  {"ok", 352}, // KEY_OK
+  {"onscreen_keyboard", 632}, // KEY_ONSCREEN_KEYBOARD
+  {"open", 134}, // KEY_OPEN
+  {"option", 357}, // KEY_OPTION
+  {"p", 25}, // KEY_P
+  {"pagedown", 109}, // KEY_PAGEDOWN
+  {"pageup", 104}, // KEY_PAGEUP
+  {"paste", 135}, // KEY_PASTE
+  {"pause", 119}, // KEY_PAUSE
+  {"pause_record", 626}, // KEY_PAUSE_RECORD
+  {"pausecd", 201}, // KEY_PAUSECD
+  {"pc", 376}, // KEY_PC
+  {"phone", 169}, // KEY_PHONE
+  {"pickup_phone", 445}, // KEY_PICKUP_PHONE
+  {"play", 207}, // KEY_PLAY
+  {"playcd", 200}, // KEY_PLAYCD
+  {"player", 387}, // KEY_PLAYER
+  {"playpause", 164}, // KEY_PLAYPAUSE
+  {"power", 116}, // KEY_POWER
+  {"power2", 356}, // KEY_POWER2
+  {"presentation", 425}, // KEY_PRESENTATION
+  {"previous", 412}, // KEY_PREVIOUS
+  {"previous_element", 636}, // KEY_PREVIOUS_ELEMENT
+  {"previoussong", 165}, // KEY_PREVIOUSSONG
+  {"print", 210}, // KEY_PRINT
+  {"privacy_screen_toggle", 633}, // KEY_PRIVACY_SCREEN_TOGGLE
+  {"prog1", 148}, // KEY_PROG1
+  {"prog2", 149}, // KEY_PROG2
+  {"prog3", 202}, // KEY_PROG3
+  {"prog4", 203}, // KEY_PROG4
+  {"program", 362}, // KEY_PROGRAM
+  {"props", 130}, // KEY_PROPS
+  {"pvr", 366}, // KEY_PVR
+  {"q", 16}, // KEY_Q
+  {"question", 214}, // KEY_QUESTION
+  {"r", 19}, // KEY_R
+  {"radar_overlay", 644}, // KEY_RADAR_OVERLAY
+  {"radio", 385}, // KEY_RADIO
+  {"record", 167}, // KEY_RECORD
+  {"red", 398}, // KEY_RED
+  {"redo", 182}, // KEY_REDO
+  {"refresh", 173}, // KEY_REFRESH
+  {"refresh_rate_toggle", 562}, // KEY_REFRESH_RATE_TOGGLE
+  {"reply", 232}, // KEY_REPLY
+  {"reserved", 0}, // KEY_RESERVED
+  {"restart", 408}, // KEY_RESTART
+  {"rewind", 168}, // KEY_REWIND
+  {"rfkill", 247}, // KEY_RFKILL
+  {"right", 106}, // KEY_RIGHT
+  {"right_down", 615}, // KEY_RIGHT_DOWN
+  {"right_up", 614}, // KEY_RIGHT_UP
+  {"rightalt", 100}, // KEY_RIGHTALT
+  {"rightbrace", 27}, // KEY_RIGHTBRACE
+  {"rightctrl", 97}, // KEY_RIGHTCTRL
+  {"rightmeta", 126}, // KEY_RIGHTMETA
+  {"rightshift", 54}, // KEY_RIGHTSHIFT
+  {"ro", 89}, // KEY_RO
+  {"root_menu", 618}, // KEY_ROOT_MENU
+  {"rotate_display", 153}, // KEY_ROTATE_DISPLAY
+  {"rotate_lock_toggle", 561}, // KEY_ROTATE_LOCK_TOGGLE
+  {"s", 31}, // KEY_S
+  {"sat", 381}, // KEY_SAT
+  {"sat2", 382}, // KEY_SAT2
+  {"save", 234}, // KEY_SAVE
+  {"scale", 120}, // KEY_SCALE
+  {"screen", 375}, // KEY_SCREEN
+  {"screenlock", 152}, // KEY_SCREENLOCK
+  {"screensaver", 581}, // KEY_SCREENSAVER
+  {"scrolldown", 178}, // KEY_SCROLLDOWN
+  {"scrolllock", 70}, // KEY_SCROLLLOCK
+  {"scrollup", 177}, // KEY_SCROLLUP
+  {"search", 217}, // KEY_SEARCH
+  {"select", 353}, // KEY_SELECT
+  {"selective_screenshot", 634}, // KEY_SELECTIVE_SCREENSHOT
+  {"semicolon", 39}, // KEY_SEMICOLON
+  {"send", 231}, // KEY_SEND
+  {"sendfile", 145}, // KEY_SENDFILE
+  {"setup", 141}, // KEY_SETUP
+  {"shift", 42}, // KEY_LEFTSHIFT
+  {"shop", 221}, // KEY_SHOP
+  {"shuffle", 410}, // KEY_SHUFFLE
+  {"sidevu_sonar", 647}, // KEY_SIDEVU_SONAR
+  {"single_range_radar", 642}, // KEY_SINGLE_RANGE_RADAR
+  {"slash", 53}, // KEY_SLASH
+  {"sleep", 142}, // KEY_SLEEP
+  {"slow", 409}, // KEY_SLOW
+  {"slowreverse", 630}, // KEY_SLOWREVERSE
+  {"sos", 639}, // KEY_SOS
+  {"sound", 213}, // KEY_SOUND
+  {"space", 57}, // KEY_SPACE
+  {"spellcheck", 432}, // KEY_SPELLCHECK
+  {"sport", 220}, // KEY_SPORT
+  {"spreadsheet", 423}, // KEY_SPREADSHEET
+  {"stop", 128}, // KEY_STOP
+  {"stop_record", 625}, // KEY_STOP_RECORD
+  {"stopcd", 166}, // KEY_STOPCD
+  {"subtitle", 370}, // KEY_SUBTITLE
+  {"suspend", 205}, // KEY_SUSPEND
+  {"switchvideomode", 227}, // KEY_SWITCHVIDEOMODE
+  {"sysrq", 99}, // KEY_SYSRQ
+  {"t", 20}, // KEY_T
+  {"tab", 15}, // KEY_TAB
+  {"tape", 384}, // KEY_TAPE
+  {"taskmanager", 577}, // KEY_TASKMANAGER
+  {"teen", 414}, // KEY_TEEN
+  {"text", 388}, // KEY_TEXT
+  {"time", 359}, // KEY_TIME
+  {"title", 369}, // KEY_TITLE
+  {"touchpad_off", 532}, // KEY_TOUCHPAD_OFF
+  {"touchpad_on", 531}, // KEY_TOUCHPAD_ON
+  {"touchpad_toggle", 530}, // KEY_TOUCHPAD_TOGGLE
+  {"traditional_sonar", 645}, // KEY_TRADITIONAL_SONAR
+  {"tuner", 386}, // KEY_TUNER
+  {"tv", 377}, // KEY_TV
+  {"tv2", 378}, // KEY_TV2
+  {"twen", 415}, // KEY_TWEN
+  {"u", 22}, // KEY_U
+  {"undo", 131}, // KEY_UNDO
+  {"unknown", 240}, // KEY_UNKNOWN
+  {"unmute", 628}, // KEY_UNMUTE
+  {"up", 103}, // KEY_UP
+  {"uwb", 239}, // KEY_UWB
+  {"v", 47}, // KEY_V
+  {"vcr", 379}, // KEY_VCR
+  {"vcr2", 380}, // KEY_VCR2
+  {"vendor", 360}, // KEY_VENDOR
+  {"video", 393}, // KEY_VIDEO
+  {"video_next", 241}, // KEY_VIDEO_NEXT
+  {"video_prev", 242}, // KEY_VIDEO_PREV
+  {"videophone", 416}, // KEY_VIDEOPHONE
+  {"vod", 627}, // KEY_VOD
+  {"voicecommand", 582}, // KEY_VOICECOMMAND
+  {"voicemail", 428}, // KEY_VOICEMAIL
+  {"volumedown", 114}, // KEY_VOLUMEDOWN
+  {"volumeup", 115}, // KEY_VOLUMEUP
+  {"w", 17}, // KEY_W
+  {"wakeup", 143}, // KEY_WAKEUP
+  {"wimax", 246}, // KEY_WIMAX
+  {"wlan", 238}, // KEY_WLAN
+  {"wordprocessor", 421}, // KEY_WORDPROCESSOR
+  {"wps_button", 529}, // KEY_WPS_BUTTON
+  {"wwan", 246}, // KEY_WWAN
+  {"www", 150}, // KEY_WWW
+  {"x", 45}, // KEY_X
+  {"xfer", 147}, // KEY_XFER
+  {"y", 21}, // KEY_Y
+  {"yellow", 400}, // KEY_YELLOW
+  {"yen", 124}, // KEY_YEN
+  {"z", 44}, // KEY_Z
+  {"zenkakuhankaku", 85}, // KEY_ZENKAKUHANKAKU
+  {"zoom", 372}, // KEY_ZOOM
+  {"zoomin", 418}, // KEY_ZOOMIN
+  {"zoomout", 419}, // KEY_ZOOMOUT
+  {"zoomreset", 420}, // KEY_ZOOMRESET
+  {"{", 26}, // KEY_LEFTBRACE; with SHIFT
+  {"|", 43}, // KEY_BACKSLASH; with SHIFT
+  {"}", 27}, // KEY_RIGHTBRACE; with SHIFT
+  {"~", 41}, // KEY_GRAVE; with SHIFT, dead key
+};
+
+// one name per code for diagnostics, sorted by code
+constexpr keycode_name keycode_canonical_names[] = {
+  {"reserved", 0},
+  {"esc", 1},
+  {"1", 2},
+  {"2", 3},
+  {"3", 4},
+  {"4", 5},
+  {"5", 6},
+  {"6", 7},
+  {"7", 8},
+  {"8", 9},
+  {"9", 10},
+  {"0", 11},
+  {"minus", 12},
+  {"equal", 13},
+  {"backspace", 14},
+  {"tab", 15},
+  {"q", 16},
+  {"w", 17},
+  {"e", 18},
+  {"r", 19},
+  {"t", 20},
+  {"y", 21},
+  {"u", 22},
+  {"i", 23},
+  {"o", 24},
+  {"p", 25},
+  {"leftbrace", 26},
+  {"rightbrace", 27},
+  {"enter", 28},
+  {"leftctrl", 29},
+  {"a", 30},
+  {"s", 31},
+  {"d", 32},
+  {"f", 33},
+  {"g", 34},
+  {"h", 35},
+  {"j", 36},
+  {"k", 37},
+  {"l", 38},
+  {"semicolon", 39},
+  {"apostrophe", 40},
+  {"grave", 41},
+  {"leftshift", 42},
+  {"backslash", 43},
+  {"z", 44},
+  {"x", 45},
+  {"c", 46},
+  {"v", 47},
+  {"b", 48},
+  {"n", 49},
+  {"m", 50},
+  {"comma", 51},
+  {"dot", 52},
+  {"slash", 53},
+  {"rightshift", 54},
+  {"kpasterisk", 55},
+  {"leftalt", 56},
+  {"space", 57},
+  {"capslock", 58},
+  {"f1", 59},
+  {"f2", 60},
+  {"f3", 61},
+  {"f4", 62},
+  {"f5", 63},
+  {"f6", 64},
+  {"f7", 65},
+  {"f8", 66},
+  {"f9", 67},
+  {"f10", 68},
+  {"numlock", 69},
+  {"scrolllock", 70},
+  {"kp7", 71},
+  {"kp8", 72},
+  {"kp9", 73},
+  {"kpminus", 74},
+  {"kp4", 75},
+  {"kp5", 76},
+  {"kp6", 77},
+  {"kpplus", 78},
+  {"kp1", 79},
+  {"kp2", 80},
+  {"kp3", 81},
+  {"kp0", 82},
+  {"kpdot", 83},
+  {"zenkakuhankaku", 85},
+  {"102nd", 86},
+  {"f11", 87},
+  {"f12", 88},
+  {"ro", 89},
+  {"katakana", 90},
+  {"hiragana", 91},
+  {"henkan", 92},
+  {"katakanahiragana", 93},
+  {"muhenkan", 94},
+  {"kpjpcomma", 95},
+  {"kpenter", 96},
+  {"rightctrl", 97},
+  {"kpslash", 98},
+  {"sysrq", 99},
+  {"rightalt", 100},
+  {"linefeed", 101},
+  {"home", 102},
+  {"up", 103},
+  {"pageup", 104},
+  {"left", 105},
+  {"right", 106},
+  {"end", 107},
+  {"down", 108},
+  {"pagedown", 109},
+  {"insert", 110},
+  {"delete", 111},
+  {"macro", 112},
+  {"mute", 113},
+  {"volumedown", 114},
+  {"volumeup", 115},
+  {"power", 116},
+  {"kpequal", 117},
+  {"kpplusminus", 118},
+  {"pause", 119},
+  {"scale", 120},
+  {"kpcomma", 121},
+  {"hangeul", 122},
+  {"hanja", 123},
+  {"yen", 124},
+  {"leftmeta", 125},
+  {"rightmeta", 126},
+  {"compose", 127},
+  {"stop", 128},
+  {"again", 129},
+  {"props", 130},
+  {"undo", 131},
+  {"front", 132},
+  {"copy", 133},
+  {"open", 134},
+  {"paste", 135},
+  {"find", 136},
+  {"cut", 137},
+  {"help", 138},
+  {"menu", 139},
+  {"calc", 140},
+  {"setup", 141},
+  {"sleep", 142},
+  {"wakeup", 143},
+  {"file", 144},
+  {"sendfile", 145},
+  {"deletefile", 146},
+  {"xfer", 147},
+  {"prog1", 148},
+  {"prog2", 149},
+  {"www", 150},
+  {"msdos", 151},
+  {"coffee", 152},
+  {"rotate_display", 153},
+  {"cyclewindows", 154},
+  {"mail", 155},
+  {"bookmarks", 156},
+  {"computer", 157},
+  {"back", 158},
+  {"forward", 159},
+  {"closecd", 160},
+  {"ejectcd", 161},
+  {"ejectclosecd", 162},
+  {"nextsong", 163},
+  {"playpause", 164},
+  {"previoussong", 165},
+  {"stopcd", 166},
+  {"record", 167},
+  {"rewind", 168},
+  {"phone", 169},
+  {"iso", 170},
+  {"config", 171},
+  {"homepage", 172},
+  {"refresh", 173},
+  {"exit", 174},
+  {"move", 175},
+  {"edit", 176},
+  {"scrollup", 177},
+  {"scrolldown", 178},
+  {"kpleftparen", 179},
+  {"kprightparen", 180},
+  {"new", 181},
+  {"redo", 182},
+  {"f13", 183},
+  {"f14", 184},
+  {"f15", 185},
+  {"f16", 186},
+  {"f17", 187},
+  {"f18", 188},
+  {"f19", 189},
+  {"f20", 190},
+  {"f21", 191},
+  {"f22", 192},
+  {"f23", 193},
+  {"f24", 194},
+  {"playcd", 200},
+  {"pausecd", 201},
+  {"prog3", 202},
+  {"prog4", 203},
+  {"all_applications", 204},
+  {"suspend", 205},
+  {"close", 206},
+  {"play", 207},
+  {"fastforward", 208},
+  {"bassboost", 209},
+  {"print", 210},
+  {"hp", 211},
+  {"camera", 212},
+  {"sound", 213},
+  {"question", 214},
+  {"email", 215},
+  {"chat", 216},
+  {"search", 217},
+  {"connect", 218},
+  {"finance", 219},
+  {"sport", 220},
+  {"shop", 221},
+  {"alterase", 222},
+  {"cancel", 223},
+  {"brightnessdown", 224},
+  {"brightnessup", 225},
+  {"media", 226},
+  {"switchvideomode", 227},
+  {"kbdillumtoggle", 228},
+  {"kbdillumdown", 229},
+  {"kbdillumup", 230},
+  {"send", 231},
+  {"reply", 232},
+  {"forwardmail", 233},
+  {"save", 234},
+  {"documents", 235},
+  {"battery", 236},
+  {"bluetooth", 237},
+  {"wlan", 238},
+  {"uwb", 239},
+  {"unknown", 240},
+  {"video_next", 241},
+  {"video_prev", 242},
+  {"brightness_cycle", 243},
+  {"brightness_auto", 244},
+  {"display_off", 245},
+  {"wwan", 246},
+  {"rfkill", 247},
+  {"micmute", 248},
+  {"btn_0", 256},
+  {"btn_1", 257},
+  {"btn_2", 258},
+  {"btn_3", 259},
+  {"btn_4", 260},
+  {"btn_5", 261},
+  {"btn_6", 262},
+  {"btn_7", 263},
+  {"btn_8", 264},
+  {"btn_9", 265},
+  {"btn_left", 272},
+  {"btn_right", 273},
+  {"btn_middle", 274},
+  {"btn_side", 275},
+  {"btn_extra", 276},
+  {"btn_forward", 277},
+  {"btn_back", 278},
+  {"btn_task", 279},
+  {"btn_trigger", 288},
+  {"btn_thumb", 289},
+  {"btn_thumb2", 290},
+  {"btn_top", 291},
+  {"btn_top2", 292},
+  {"btn_pinkie", 293},
+  {"btn_base", 294},
+  {"btn_base2", 295},
+  {"btn_base3", 296},
+  {"btn_base4", 297},
+  {"btn_base5", 298},
+  {"btn_base6", 299},
+  {"btn_dead", 303},
+  {"btn_south", 304},
+  {"btn_east", 305},
+  {"btn_c", 306},
+  {"btn_north", 307},
+  {"btn_west", 308},
+  {"btn_z", 309},
+  {"btn_tl", 310},
+  {"btn_tr", 311},
+  {"btn_tl2", 312},
+  {"btn_tr2", 313},
+  {"btn_select", 314},
+  {"btn_start", 315},
+  {"btn_mode", 316},
+  {"btn_thumbl", 317},
+  {"btn_thumbr", 318},
+  {"btn_tool_pen", 320},
+  {"btn_tool_rubber", 321},
+  {"btn_tool_brush", 322},
+  {"btn_tool_pencil", 323},
+  {"btn_tool_airbrush", 324},
+  {"btn_tool_finger", 325},
+  {"btn_tool_mouse", 326},
+  {"btn_tool_lens", 327},
+  {"btn_tool_quinttap", 328},
+  {"btn_stylus3", 329},
+  {"btn_touch", 330},
+  {"btn_stylus", 331},
+  {"btn_stylus2", 332},
+  {"btn_tool_doubletap", 333},
+  {"btn_tool_tripletap", 334},
+  {"btn_tool_quadtap", 335},
+  {"btn_gear_down", 336},
+  {"btn_gear_up", 337},
+  {"ok", 352},
+  {"select", 353},
+  {"goto", 354},
+  {"clear", 355},
+  {"power2", 356},
+  {"option", 357},
+  {"info", 358},
+  {"time", 359},
+  {"vendor", 360},
+  {"archive", 361},
+  {"program", 362},
+  {"channel", 363},
+  {"favorites", 364},
+  {"epg", 365},
+  {"pvr", 366},
+  {"mhp", 367},
+  {"language", 368},
+  {"title", 369},
+  {"subtitle", 370},
+  {"angle", 371},
+  {"full_screen", 372},
+  {"mode", 373},
+  {"keyboard", 374},
+  {"aspect_ratio", 375},
+  {"pc", 376},
+  {"tv", 377},
+  {"tv2", 378},
+  {"vcr", 379},
+  {"vcr2", 380},
+  {"sat", 381},
+  {"sat2", 382},
+  {"cd", 383},
+  {"tape", 384},
+  {"radio", 385},
+  {"tuner", 386},
+  {"player", 387},
+  {"text", 388},
+  {"dvd", 389},
+  {"aux", 390},
+  {"mp3", 391},
+  {"audio", 392},
+  {"video", 393},
+  {"directory", 394},
+  {"list", 395},
+  {"memo", 396},
+  {"calendar", 397},
+  {"red", 398},
+  {"green", 399},
+  {"yellow", 400},
+  {"blue", 401},
+  {"channelup", 402},
+  {"channeldown", 403},
+  {"first", 404},
+  {"last", 405},
+  {"ab", 406},
+  {"next", 407},
+  {"restart", 408},
+  {"slow", 409},
+  {"shuffle", 410},
+  {"break", 411},
+  {"previous", 412},
+  {"digits", 413},
+  {"teen", 414},
+  {"twen", 415},
+  {"videophone", 416},
+  {"games", 417},
+  {"zoomin", 418},
+  {"zoomout", 419},
+  {"zoomreset", 420},
+  {"wordprocessor", 421},
+  {"editor", 422},
+  {"spreadsheet", 423},
+  {"graphicseditor", 424},
+  {"presentation", 425},
+  {"database", 426},
+  {"news", 427},
+  {"voicemail", 428},
+  {"addressbook", 429},
+  {"messenger", 430},
+  {"displaytoggle", 431},
+  {"spellcheck", 432},
+  {"logoff", 433},
+  {"dollar", 434},
+  {"euro", 435},
+  {"frameback", 436},
+  {"frameforward", 437},
+  {"context_menu", 438},
+  {"media_repeat", 439},
+  {"10channelsup", 440},
+  {"10channelsdown", 441},
+  {"images", 442},
+  {"notification_center", 444},
+  {"pickup_phone", 445},
+  {"hangup_phone", 446},
+  {"link_phone", 447},
+  {"del_eol", 448},
+  {"del_eos", 449},
+  {"ins_line", 450},
+  {"del_line", 451},
+  {"fn", 464},
+  {"fn_esc", 465},
+  {"fn_f1", 466},
+  {"fn_f2", 467},
+  {"fn_f3", 468},
+  {"fn_f4", 469},
+  {"fn_f5", 470},
+  {"fn_f6", 471},
+  {"fn_f7", 472},
+  {"fn_f8", 473},
+  {"fn_f9", 474},
+  {"fn_f10", 475},
+  {"fn_f11", 476},
+  {"fn_f12", 477},
+  {"fn_1", 478},
+  {"fn_2", 479},
+  {"fn_d", 480},
+  {"fn_e", 481},
+  {"fn_f", 482},
+  {"fn_s", 483},
+  {"fn_b", 484},
+  {"fn_right_shift", 485},
+  {"brl_dot1", 497},
+  {"brl_dot2", 498},
+  {"brl_dot3", 499},
+  {"brl_dot4", 500},
+  {"brl_dot5", 501},
+  {"brl_dot6", 502},
+  {"brl_dot7", 503},
+  {"brl_dot8", 504},
+  {"brl_dot9", 505},
+  {"brl_dot10", 506},
+  {"numeric_0", 512},
+  {"numeric_1", 513},
+  {"numeric_2", 514},
+  {"numeric_3", 515},
+  {"numeric_4", 516},
+  {"numeric_5", 517},
+  {"numeric_6", 518},
+  {"numeric_7", 519},
+  {"numeric_8", 520},
+  {"numeric_9", 521},
+  {"numeric_star", 522},
+  {"numeric_pound", 523},
+  {"numeric_a", 524},
+  {"numeric_b", 525},
+  {"numeric_c", 526},
+  {"numeric_d", 527},
+  {"camera_focus", 528},
+  {"wps_button", 529},
+  {"touchpad_toggle", 530},
+  {"touchpad_on", 531},
+  {"touchpad_off", 532},
+  {"camera_zoomin", 533},
+  {"camera_zoomout", 534},
+  {"camera_up", 535},
+  {"camera_down", 536},
+  {"camera_left", 537},
+  {"camera_right", 538},
+  {"attendant_on", 539},
+  {"attendant_off", 540},
+  {"attendant_toggle", 541},
+  {"lights_toggle", 542},
+  {"btn_dpad_up", 544},
+  {"btn_dpad_down", 545},
+  {"btn_dpad_left", 546},
+  {"btn_dpad_right", 547},
+  {"als_toggle", 560},
+  {"rotate_lock_toggle", 561},
+  {"refresh_rate_toggle", 562},
+  {"buttonconfig", 576},
+  {"taskmanager", 577},
+  {"journal", 578},
+  {"controlpanel", 579},
+  {"appselect", 580},
+  {"screensaver", 581},
+  {"voicecommand", 582},
+  {"assistant", 583},
+  {"kbd_layout_next", 584},
+  {"emoji_picker", 585},
+  {"dictate", 586},
+  {"brightness_min", 592},
+  {"brightness_max", 593},
+  {"kbdinputassist_prev", 608},
+  {"kbdinputassist_next", 609},
+  {"kbdinputassist_prevgroup", 610},
+  {"kbdinputassist_nextgroup", 611},
+  {"kbdinputassist_accept", 612},
+  {"kbdinputassist_cancel", 613},
+  {"right_up", 614},
+  {"right_down", 615},
+  {"left_up", 616},
+  {"left_down", 617},
+  {"root_menu", 618},
+  {"media_top_menu", 619},
+  {"numeric_11", 620},
+  {"numeric_12", 621},
+  {"audio_desc", 622},
+  {"3d_mode", 623},
+  {"next_favorite", 624},
+  {"stop_record", 625},
+  {"pause_record", 626},
+  {"vod", 627},
+  {"unmute", 628},
+  {"fastreverse", 629},
+  {"slowreverse", 630},
+  {"data", 631},
+  {"onscreen_keyboard", 632},
+  {"privacy_screen_toggle", 633},
+  {"selective_screenshot", 634},
+  {"next_element", 635},
+  {"previous_element", 636},
+  {"autopilot_engage_toggle", 637},
+  {"mark_waypoint", 638},
+  {"sos", 639},
+  {"nav_chart", 640},
+  {"fishing_chart", 641},
+  {"single_range_radar", 642},
+  {"dual_range_radar", 643},
+  {"radar_overlay", 644},
+  {"traditional_sonar", 645},
+  {"clearvu_sonar", 646},
+  {"sidevu_sonar", 647},
+  {"nav_info", 648},
+  {"brightness_menu", 649},
+  {"macro1", 656},
+  {"macro2", 657},
+  {"macro3", 658},
+  {"macro4", 659},
+  {"macro5", 660},
+  {"macro6", 661},
+  {"macro7", 662},
+  {"macro8", 663},
+  {"macro9", 664},
+  {"macro10", 665},
+  {"macro11", 666},
+  {"macro12", 667},
+  {"macro13", 668},
+  {"macro14", 669},
+  {"macro15", 670},
+  {"macro16", 671},
+  {"macro17", 672},
+  {"macro18", 673},
+  {"macro19", 674},
+  {"macro20", 675},
+  {"macro21", 676},
+  {"macro22", 677},
+  {"macro23", 678},
+  {"macro24", 679},
+  {"macro25", 680},
+  {"macro26", 681},
+  {"macro27", 682},
+  {"macro28", 683},
+  {"macro29", 684},
+  {"macro30", 685},
+  {"macro_record_start", 688},
+  {"macro_record_stop", 689},
+  {"macro_preset_cycle", 690},
+  {"macro_preset1", 691},
+  {"macro_preset2", 692},
+  {"macro_preset3", 693},
+  {"kbd_lcd_menu1", 696},
+  {"kbd_lcd_menu2", 697},
+  {"kbd_lcd_menu3", 698},
+  {"kbd_lcd_menu4", 699},
+  {"kbd_lcd_menu5", 700},
+  {"btn_trigger_happy1", 704},
+  {"btn_trigger_happy2", 705},
+  {"btn_trigger_happy3", 706},
+  {"btn_trigger_happy4", 707},
+  {"btn_trigger_happy5", 708},
+  {"btn_trigger_happy6", 709},
+  {"btn_trigger_happy7", 710},
+  {"btn_trigger_happy8", 711},
+  {"btn_trigger_happy9", 712},
+  {"btn_trigger_happy10", 713},
+  {"btn_trigger_happy11", 714},
+  {"btn_trigger_happy12", 715},
+  {"btn_trigger_happy13", 716},
+  {"btn_trigger_happy14", 717},
+  {"btn_trigger_happy15", 718},
+  {"btn_trigger_happy16", 719},
+  {"btn_trigger_happy17", 720},
+  {"btn_trigger_happy18", 721},
+  {"btn_trigger_happy19", 722},
+  {"btn_trigger_happy20", 723},
+  {"btn_trigger_happy21", 724},
+  {"btn_trigger_happy22", 725},
+  {"btn_trigger_happy23", 726},
+  {"btn_trigger_happy24", 727},
+  {"btn_trigger_happy25", 728},
+  {"btn_trigger_happy26", 729},
+  {"btn_trigger_happy27", 730},
+  {"btn_trigger_happy28", 731},
+  {"btn_trigger_happy29", 732},
+  {"btn_trigger_happy30", 733},
+  {"btn_trigger_happy31", 734},
+  {"btn_trigger_happy32", 735},
+  {"btn_trigger_happy33", 736},
+  {"btn_trigger_happy34", 737},
+  {"btn_trigger_happy35", 738},
+  {"btn_trigger_happy36", 739},
+  {"btn_trigger_happy37", 740},
+  {"btn_trigger_happy38", 741},
+  {"btn_trigger_happy39", 742},
+  {"btn_trigger_happy40", 743},
+};
+
+#endif // GPTOKEYB_KEYCODES_H